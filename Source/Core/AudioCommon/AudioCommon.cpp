@@ -3,6 +3,9 @@
 // Refer to the license.txt file included.
 
 #include "AudioCommon/AudioCommon.h"
+
+#include <cinttypes>
+
 #include "AudioCommon/AlsaSoundStream.h"
 #include "AudioCommon/CubebStream.h"
 #include "AudioCommon/Mixer.h"
@@ -15,6 +18,7 @@
 #include "Common/Common.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
 
 // This shouldn't be a global, at least not here.
@@ -185,6 +189,24 @@ void SendAIBuffer(const short* samples, unsigned int num_samples)
   g_sound_stream->Update();
 }
 
+std::string GetStatisticsDisplay()
+{
+  Mixer::Statistics stats{};
+  if (g_sound_stream && g_sound_stream->GetMixer())
+    stats = g_sound_stream->GetMixer()->GetStatistics();
+
+  const auto format = [](const char* name, const Mixer::FifoStatistics& fifo) {
+    const unsigned int buffered_ms =
+        fifo.input_sample_rate ? fifo.buffered_frames * 1000 / fifo.input_sample_rate : 0;
+    return StringFromFormat("%s: %u ms buffered, %" PRIu64 " underruns, %" PRIu64
+                            " overruns (%" PRIu64 " frames dropped)\n",
+                            name, buffered_ms, fifo.underruns, fifo.overruns, fifo.dropped_frames);
+  };
+
+  return format("Audio DMA", stats.dma) + format("Audio Streaming", stats.streaming) +
+         format("Wii Remote Speaker", stats.wiimote_speaker);
+}
+
 void StartAudioDump()
 {
   std::string audio_file_name_dtk = File::GetUserPath(D_DUMPAUDIO_IDX) + "dtkdump.wav";
@@ -26,6 +26,7 @@ bool SupportsVolumeChanges(const std::string& backend);
 void UpdateSoundStream();
 void SetSoundStreamRunning(bool running);
 void SendAIBuffer(const short* samples, unsigned int num_samples);
+std::string GetStatisticsDisplay();
 void StartAudioDump();
 void StopAudioDump();
 void IncreaseVolume(unsigned short offset);
@@ -4,6 +4,8 @@
 
 #include "AudioCommon/Mixer.h"
 
+#include <algorithm>
+#include <cinttypes>
 #include <cmath>
 #include <cstring>
 
@@ -35,31 +37,31 @@ void Mixer::DoState(PointerWrap& p)
   m_wiimote_speaker_mixer.DoState(p);
 }
 
+// Input frames that Mix needs after the position it is resampling at.
+static u32 GetResamplerLookahead()
+{
+  return SConfig::GetInstance().m_audio_sinc_resampling ? AudioCommon::Resampler::SINC_LOOKAHEAD :
+                                                          1;
+}
+
 // Executed from sound stream thread
 unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
                                    bool consider_framelimit)
 {
-  unsigned int currentSample = 0;
-
-  // Cache access in non-volatile variable
-  // This is the only function changing the read value, so it's safe to
-  // cache it locally although it's written here.
-  // The writing pointer will be modified outside, but it will only increase,
-  // so we will just ignore new written data while interpolating.
-  // Without this cache, the compiler wouldn't be allowed to optimize the
-  // interpolation loop.
-  u32 indexR = m_indexR.load();
-  u32 indexW = m_indexW.load();
+  unsigned int currentFrame = 0;
+
+  // PushSamples only ever adds frames, so we just ignore the ones written while interpolating.
+  u32 available = static_cast<u32>(m_buffer.Size() / 2);
 
   // render numleft sample pairs to samples[]
-  // advance indexR with sample position
+  // advance the read position with sample position
   // remember fractional offset
 
   float emulationspeed = SConfig::GetInstance().m_EmulationSpeed;
   float aid_sample_rate = static_cast<float>(m_input_sample_rate);
   if (consider_framelimit && emulationspeed > 0.0f)
   {
-    float numLeft = static_cast<float>(((indexW - indexR) & INDEX_MASK) / 2);
+    float numLeft = static_cast<float>(available);
 
     u32 low_waterwark = m_input_sample_rate * SConfig::GetInstance().iTimingVariance / 1000;
     low_waterwark = std::min(low_waterwark, MAX_SAMPLES / 2);
@@ -91,40 +93,102 @@ unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
   s32 lvolume = m_LVolume.load();
   s32 rvolume = m_RVolume.load();
 
-  // TODO: consider a higher-quality resampling algorithm.
-  for (; currentSample < numSamples * 2 && ((indexW - indexR) & INDEX_MASK) > 2; currentSample += 2)
+  const bool sinc = SConfig::GetInstance().m_audio_sinc_resampling;
+  if (sinc && m_sinc_table_rate != m_input_sample_rate)
+    UpdateSincTable();
+  const u32 history = AudioCommon::Resampler::SINC_HISTORY;
+  const u32 lookahead = GetResamplerLookahead();
+
+  // The input of each block is copied out of the FIFO after the frames that were already removed
+  // from it, and split into left and right channels, so that the resampling kernels can read it
+  // linearly.
+  std::array<s16, (BLOCK_FRAMES + AudioCommon::Resampler::SINC_TAPS) * 2> input;
+  std::array<s16, BLOCK_FRAMES + AudioCommon::Resampler::SINC_TAPS> input_left;
+  std::array<s16, BLOCK_FRAMES + AudioCommon::Resampler::SINC_TAPS> input_right;
+  std::array<s32, BLOCK_FRAMES> output_left;
+  std::array<s32, BLOCK_FRAMES> output_right;
+
+  u32 frac = m_frac;
+  while (currentFrame < numSamples)
   {
-    u32 indexR2 = indexR + 2;  // next sample
-
-    s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]);   // current
-    s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]);  // next
-    int sampleL = ((l1 << 16) + (l2 - l1) * (u16)m_frac) >> 16;
-    sampleL = (sampleL * lvolume) >> 8;
-    sampleL += samples[currentSample + 1];
-    samples[currentSample + 1] = MathUtil::Clamp(sampleL, -32767, 32767);
-
-    s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]);   // current
-    s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]);  // next
-    int sampleR = ((r1 << 16) + (r2 - r1) * (u16)m_frac) >> 16;
-    sampleR = (sampleR * rvolume) >> 8;
-    sampleR += samples[currentSample];
-    samples[currentSample] = MathUtil::Clamp(sampleR, -32767, 32767);
-
-    m_frac += ratio;
-    indexR += 2 * (u16)(m_frac >> 16);
-    m_frac &= 0xffff;
+    if (available <= lookahead)
+      break;
+    const u32 usable = std::min(available - lookahead, BLOCK_FRAMES);
+
+    // Output frames whose position lies within the usable input frames.
+    u32 count = std::min(numSamples - currentFrame, BLOCK_FRAMES);
+    if (ratio)
+    {
+      count = static_cast<u32>(
+          std::min<u64>(count, ((static_cast<u64>(usable) << 16) - frac + ratio - 1) / ratio));
+    }
+    const u32 last = static_cast<u32>((frac + static_cast<u64>(count - 1) * ratio) >> 16);
+
+    // Only very high ratios can step past the end of the input, which just empties the FIFO.
+    const u64 end = frac + static_cast<u64>(count) * ratio;
+    const u32 consumed = static_cast<u32>(std::min<u64>(end >> 16, available));
+
+    const u32 frames = std::max(last + lookahead + 1, std::min(consumed, history));
+    std::copy(m_history.begin(), m_history.end(), input.begin());
+    m_buffer.Peek(&input[history * 2], frames * 2);
+    for (u32 i = 0; i < history + frames; ++i)
+    {
+      input_left[i] = input[i * 2];
+      input_right[i] = input[i * 2 + 1];
+    }
+
+    if (sinc)
+    {
+      AudioCommon::Resampler::ResampleSinc(m_sinc_table, &input_left[history],
+                                           &input_right[history], output_left.data(),
+                                           output_right.data(), count, frac, ratio);
+    }
+    else
+    {
+      AudioCommon::Resampler::ResampleLinear(&input_left[history], &input_right[history],
+                                             output_left.data(), output_right.data(), count, frac,
+                                             ratio);
+    }
+
+    // The output has the right channel first.
+    short* out = &samples[currentFrame * 2];
+    for (u32 i = 0; i < count; ++i)
+    {
+      const int sampleL = ((output_left[i] * lvolume) >> 8) + out[i * 2 + 1];
+      const int sampleR = ((output_right[i] * rvolume) >> 8) + out[i * 2];
+      out[i * 2 + 1] = MathUtil::Clamp(sampleL, -32767, 32767);
+      out[i * 2] = MathUtil::Clamp(sampleR, -32767, 32767);
+    }
+
+    // Keep the frames before the new read position for the next block.
+    if (consumed <= frames)
+      std::copy_n(&input[consumed * 2], history * 2, m_history.begin());
+    else
+      m_buffer.Peek(m_history.data(), history * 2, (consumed - history) * 2);
+    m_buffer.Discard(consumed * 2);
+
+    available -= consumed;
+    frac = static_cast<u32>(end & 0xFFFF);
+    currentFrame += count;
   }
+  m_frac = frac;
 
   // Actual number of samples written to the buffer without padding.
-  unsigned int actual_sample_count = currentSample / 2;
+  unsigned int actual_sample_count = currentFrame;
+
+  // Only count running dry once, rather than for every call until more input arrives.
+  if (actual_sample_count < numSamples && !m_starved)
+    m_underruns++;
+  m_starved = actual_sample_count < numSamples;
 
   // Padding
   short s[2];
-  s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
-  s[1] = Common::swap16(m_buffer[(indexR - 2) & INDEX_MASK]);
+  s[0] = m_history[history * 2 - 1];
+  s[1] = m_history[history * 2 - 2];
   s[0] = (s[0] * rvolume) >> 8;
   s[1] = (s[1] * lvolume) >> 8;
-  for (; currentSample < numSamples * 2; currentSample += 2)
+  for (unsigned int currentSample = currentFrame * 2; currentSample < numSamples * 2;
+       currentSample += 2)
   {
     int sampleR = MathUtil::Clamp(s[0] + samples[currentSample + 0], -32767, 32767);
     int sampleL = MathUtil::Clamp(s[1] + samples[currentSample + 1], -32767, 32767);
@@ -133,9 +197,6 @@ unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
     samples[currentSample + 1] = sampleL;
   }
 
-  // Flush cached variable
-  m_indexR.store(indexR);
-
   return actual_sample_count;
 }
 
@@ -173,6 +234,13 @@ unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
     m_is_stretching = false;
   }
 
+  m_frames_since_log += num_samples;
+  if (m_frames_since_log >= m_sampleRate * STATISTICS_LOG_INTERVAL)
+  {
+    m_frames_since_log = 0;
+    LogStatistics();
+  }
+
   return num_samples;
 }
 
@@ -199,31 +267,50 @@ unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
 
 void Mixer::MixerFifo::PushSamples(const short* samples, unsigned int num_samples)
 {
-  // Cache access in non-volatile variable
-  // indexR isn't allowed to cache in the audio throttling loop as it
-  // needs to get updates to not deadlock.
-  u32 indexW = m_indexW.load();
-
-  // Check if we have enough free space
-  // indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-  if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
-    return;
-
   // AyuanX: Actual re-sampling work has been moved to sound thread
   // to alleviate the workload on main thread
-  // and we simply store raw data here to make fast mem copy
-  int over_bytes = num_samples * 4 - (MAX_SAMPLES * 2 - (indexW & INDEX_MASK)) * sizeof(short);
-  if (over_bytes > 0)
-  {
-    memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4 - over_bytes);
-    memcpy(&m_buffer[0], samples + (num_samples * 4 - over_bytes) / sizeof(short), over_bytes);
-  }
-  else
+  // and we simply store raw data here. The byte swap is done here once, rather than every
+  // time Mix reads a sample.
+  const auto swap = [](const short* begin, const short* end, short* out) {
+    std::transform(begin, end, out,
+                   [](short sample) { return static_cast<short>(Common::swap16(sample)); });
+  };
+
+  // Never wait for the audio thread: store what fits, and drop the rest if it's behind.
+  const size_t pushed = m_buffer.Push(samples, num_samples * 2, swap);
+  if (pushed < num_samples * 2)
   {
-    memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4);
+    m_overruns++;
+    m_dropped_frames += num_samples - pushed / 2;
   }
+}
 
-  m_indexW.fetch_add(num_samples * 2);
+Mixer::Statistics Mixer::GetStatistics() const
+{
+  return {m_dma_mixer.GetStatistics(), m_streaming_mixer.GetStatistics(),
+          m_wiimote_speaker_mixer.GetStatistics()};
+}
+
+static void LogFifoStatistics(const char* name, const Mixer::FifoStatistics& stats,
+                              const Mixer::FifoStatistics& logged)
+{
+  if (stats.underruns == logged.underruns && stats.overruns == logged.overruns)
+    return;
+
+  WARN_LOG(AUDIO, "%s FIFO: %" PRIu64 " underruns, %" PRIu64 " overruns (%" PRIu64
+                  " frames dropped), %u frames buffered",
+           name, stats.underruns - logged.underruns, stats.overruns - logged.overruns,
+           stats.dropped_frames - logged.dropped_frames, stats.buffered_frames);
+}
+
+// Executed from sound stream thread
+void Mixer::LogStatistics()
+{
+  const Statistics stats = GetStatistics();
+  LogFifoStatistics("DMA", stats.dma, m_logged_statistics.dma);
+  LogFifoStatistics("Streaming", stats.streaming, m_logged_statistics.streaming);
+  // The Wii Remote speaker only gets input while a sound plays, so running dry is expected.
+  m_logged_statistics = stats;
 }
 
 void Mixer::PushSamples(const short* samples, unsigned int num_samples)
@@ -380,8 +467,31 @@ void Mixer::MixerFifo::SetVolume(unsigned int lvolume, unsigned int rvolume)
 
 unsigned int Mixer::MixerFifo::AvailableSamples() const
 {
-  unsigned int samples_in_fifo = ((m_indexW.load() - m_indexR.load()) & INDEX_MASK) / 2;
-  if (samples_in_fifo <= 1)
-    return 0;  // Mixer::MixerFifo::Mix always keeps one sample in the buffer.
-  return (samples_in_fifo - 1) * m_mixer->m_sampleRate / m_input_sample_rate;
+  // Mixer::MixerFifo::Mix always keeps the lookahead of the resampler in the buffer.
+  const unsigned int lookahead = GetResamplerLookahead();
+  unsigned int samples_in_fifo = static_cast<unsigned int>(m_buffer.Size() / 2);
+  if (samples_in_fifo <= lookahead)
+    return 0;
+  return (samples_in_fifo - lookahead) * m_mixer->m_sampleRate / m_input_sample_rate;
+}
+
+Mixer::FifoStatistics Mixer::MixerFifo::GetStatistics() const
+{
+  FifoStatistics stats;
+  stats.input_sample_rate = m_input_sample_rate;
+  stats.buffered_frames = static_cast<unsigned int>(m_buffer.Size() / 2);
+  stats.underruns = m_underruns.load();
+  stats.overruns = m_overruns.load();
+  stats.dropped_frames = m_dropped_frames.load();
+  return stats;
+}
+
+void Mixer::MixerFifo::UpdateSincTable()
+{
+  // Filter out what the output sample rate cannot represent, with some margin for the
+  // transition band of the short filter.
+  const float rate_ratio =
+      static_cast<float>(m_mixer->m_sampleRate) / std::max(m_input_sample_rate, 1u);
+  AudioCommon::Resampler::BuildSincTable(&m_sinc_table, 0.9f * std::min(rate_ratio, 1.0f));
+  m_sinc_table_rate = m_input_sample_rate;
 }
@@ -8,8 +8,10 @@
 #include <atomic>
 
 #include "AudioCommon/AudioStretcher.h"
+#include "AudioCommon/Resampler.h"
 #include "AudioCommon/WaveFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/SPSCRingBuffer.h"
 
 class PointerWrap;
 
@@ -44,19 +46,41 @@ public:
 
   float GetCurrentSpeed() const { return m_speed.load(); }
   void UpdateSpeed(float val) { m_speed.store(val); }
+
+  struct FifoStatistics
+  {
+    unsigned int input_sample_rate;
+    unsigned int buffered_frames;
+    // Times Mix ran out of input and had to pad the output.
+    u64 underruns;
+    // Times PushSamples found the FIFO full, and the frames it dropped.
+    u64 overruns;
+    u64 dropped_frames;
+  };
+
+  struct Statistics
+  {
+    FifoStatistics dma;
+    FifoStatistics streaming;
+    FifoStatistics wiimote_speaker;
+  };
+
+  // Can be called from any thread.
+  Statistics GetStatistics() const;
+
 private:
 #if defined(_MSC_VER) && _MSC_VER <= 1800
 #define MAX_SAMPLES ((u32)(1024 * 4))  // 128 ms
-#define INDEX_MASK ((u32)(MAX_SAMPLES * 2 - 1))
 #define MAX_FREQ_SHIFT ((int)200)  // Per 32000 Hz
 #define CONTROL_FACTOR 0.2f
 #define CONTROL_AVG ((u32)(32))  // In freq_shift per FIFO size offset
+#define STATISTICS_LOG_INTERVAL ((u32)(10))  // In seconds of output
 #else
   static constexpr u32 MAX_SAMPLES = 1024 * 4;  // 128 ms
-  static constexpr u32 INDEX_MASK = MAX_SAMPLES * 2 - 1;
   static constexpr int MAX_FREQ_SHIFT = 200;  // Per 32000 Hz
   static constexpr float CONTROL_FACTOR = 0.2f;
   static constexpr u32 CONTROL_AVG = 32;  // In freq_shift per FIFO size offset
+  static constexpr u32 STATISTICS_LOG_INTERVAL = 10;  // In seconds of output
 #endif
 
   class MixerFifo final
@@ -72,20 +96,39 @@ private:
     unsigned int GetInputSampleRate() const;
     void SetVolume(unsigned int lvolume, unsigned int rvolume);
     unsigned int AvailableSamples() const;
+    FifoStatistics GetStatistics() const;
 
   private:
+    // Output frames resampled at once by Mix.
+    static constexpr u32 BLOCK_FRAMES = 256;
+
+    void UpdateSincTable();
+
     Mixer* m_mixer;
     unsigned m_input_sample_rate;
-    std::array<short, MAX_SAMPLES * 2> m_buffer{};
-    std::atomic<u32> m_indexW{0};
-    std::atomic<u32> m_indexR{0};
+    // Interleaved left/right samples, already converted to native endianness. PushSamples is the
+    // only writer and Mix the only reader.
+    Common::SPSCRingBuffer<short, MAX_SAMPLES * 2> m_buffer;
     // Volume ranges from 0-256
     std::atomic<s32> m_LVolume{256};
     std::atomic<s32> m_RVolume{256};
     float m_numLeftI = 0.0f;
     u32 m_frac = 0;
+
+    std::atomic<u64> m_underruns{0};
+    std::atomic<u64> m_overruns{0};
+    std::atomic<u64> m_dropped_frames{0};
+
+    // Only used from the audio thread.
+    AudioCommon::Resampler::SincTable m_sinc_table;
+    unsigned int m_sinc_table_rate = 0;
+    // The last frames removed from m_buffer, which the sinc resampler reads before the position.
+    std::array<short, AudioCommon::Resampler::SINC_HISTORY * 2> m_history{};
+    bool m_starved = true;
   };
 
+  void LogStatistics();
+
   MixerFifo m_dma_mixer{this, 32000};
   MixerFifo m_streaming_mixer{this, 48000};
   MixerFifo m_wiimote_speaker_mixer{this, 3000};
@@ -104,4 +147,8 @@ private:
 
   // Current rate of emulation (1.0 = 100% speed)
   std::atomic<float> m_speed{0.0f};
+
+  // Only used from the audio thread.
+  unsigned int m_frames_since_log = 0;
+  Statistics m_logged_statistics{};
 };
@@ -0,0 +1,164 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "AudioCommon/Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "Common/CommonTypes.h"
+
+#if defined(_M_X86) || defined(_M_X86_64)
+#include "Common/Intrinsics.h"
+#elif defined(_M_ARM_64)
+#include <arm_neon.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace AudioCommon
+{
+namespace Resampler
+{
+void BuildSincTable(SincTable* table, float cutoff)
+{
+  const double half_width = SINC_TAPS / 2;
+
+  for (u32 phase = 0; phase < SINC_PHASES; ++phase)
+  {
+    // Tap i weights input frame i - SINC_HISTORY, at this distance from the position.
+    const double frac = static_cast<double>(phase) / SINC_PHASES;
+    double taps[SINC_TAPS];
+    double sum = 0.0;
+    for (u32 i = 0; i < SINC_TAPS; ++i)
+    {
+      const double x = static_cast<double>(i) - SINC_HISTORY - frac;
+      const double arg = M_PI * cutoff * x;
+      const double sinc = x == 0.0 ? 1.0 : std::sin(arg) / arg;
+      const double w = M_PI * (x + half_width) / half_width;
+      const double window = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+      taps[i] = sinc * window;
+      sum += taps[i];
+    }
+
+    // Normalize for unity gain, and put the rounding error on the largest tap.
+    std::array<s16, SINC_TAPS>& coefs = table->phases[phase];
+    s32 total = 0;
+    u32 largest = 0;
+    for (u32 i = 0; i < SINC_TAPS; ++i)
+    {
+      coefs[i] = static_cast<s16>(std::lround(taps[i] / sum * (1 << 14)));
+      total += coefs[i];
+      if (std::abs(coefs[i]) > std::abs(coefs[largest]))
+        largest = i;
+    }
+    coefs[largest] += static_cast<s16>((1 << 14) - total);
+  }
+}
+
+u32 ResampleLinear(const s16* left, const s16* right, s32* out_left, s32* out_right, u32 count,
+                   u32 pos, u32 ratio)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    const u32 index = pos >> 16;
+    const s32 frac = pos & 0xFFFF;
+    out_left[i] = (left[index] * (0x10000 - frac) + left[index + 1] * frac) >> 16;
+    out_right[i] = (right[index] * (0x10000 - frac) + right[index + 1] * frac) >> 16;
+    pos += ratio;
+  }
+  return pos;
+}
+
+static s32 Round(s32 sum)
+{
+  return (sum + (1 << 13)) >> 14;
+}
+
+#if defined(_M_X86) || defined(_M_X86_64)
+// SSE2 is part of the x86-64 baseline, so this needs no runtime check.
+u32 ResampleSinc(const SincTable& table, const s16* left, const s16* right, s32* out_left,
+                 s32* out_right, u32 count, u32 pos, u32 ratio)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    const s16* l = left + (pos >> 16) - SINC_HISTORY;
+    const s16* r = right + (pos >> 16) - SINC_HISTORY;
+    const s16* coefs = table.phases[(pos & 0xFFFF) >> (16 - SINC_PHASE_BITS)].data();
+
+    const __m128i c0 = _mm_load_si128(reinterpret_cast<const __m128i*>(coefs));
+    const __m128i c1 = _mm_load_si128(reinterpret_cast<const __m128i*>(coefs + 8));
+    const __m128i sum_l = _mm_add_epi32(
+        _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(l)), c0),
+        _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(l + 8)), c1));
+    const __m128i sum_r = _mm_add_epi32(
+        _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r)), c0),
+        _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r + 8)), c1));
+
+    // Horizontal sums: {l0 + l2, r0 + r2, l1 + l3, r1 + r3}, then fold the upper half.
+    __m128i sums =
+        _mm_add_epi32(_mm_unpacklo_epi32(sum_l, sum_r), _mm_unpackhi_epi32(sum_l, sum_r));
+    sums = _mm_add_epi32(sums, _mm_srli_si128(sums, 8));
+
+    out_left[i] = Round(_mm_cvtsi128_si32(sums));
+    out_right[i] = Round(_mm_cvtsi128_si32(_mm_srli_si128(sums, 4)));
+    pos += ratio;
+  }
+  return pos;
+}
+#elif defined(_M_ARM_64)
+u32 ResampleSinc(const SincTable& table, const s16* left, const s16* right, s32* out_left,
+                 s32* out_right, u32 count, u32 pos, u32 ratio)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    const s16* l = left + (pos >> 16) - SINC_HISTORY;
+    const s16* r = right + (pos >> 16) - SINC_HISTORY;
+    const s16* coefs = table.phases[(pos & 0xFFFF) >> (16 - SINC_PHASE_BITS)].data();
+
+    int32x4_t sum_l = vdupq_n_s32(0);
+    int32x4_t sum_r = vdupq_n_s32(0);
+    for (u32 j = 0; j < SINC_TAPS; j += 4)
+    {
+      const int16x4_t c = vld1_s16(coefs + j);
+      sum_l = vmlal_s16(sum_l, vld1_s16(l + j), c);
+      sum_r = vmlal_s16(sum_r, vld1_s16(r + j), c);
+    }
+
+    out_left[i] = Round(vaddvq_s32(sum_l));
+    out_right[i] = Round(vaddvq_s32(sum_r));
+    pos += ratio;
+  }
+  return pos;
+}
+#else
+u32 ResampleSinc(const SincTable& table, const s16* left, const s16* right, s32* out_left,
+                 s32* out_right, u32 count, u32 pos, u32 ratio)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    const s16* l = left + (pos >> 16) - SINC_HISTORY;
+    const s16* r = right + (pos >> 16) - SINC_HISTORY;
+    const s16* coefs = table.phases[(pos & 0xFFFF) >> (16 - SINC_PHASE_BITS)].data();
+
+    s32 sum_l = 0;
+    s32 sum_r = 0;
+    for (u32 j = 0; j < SINC_TAPS; ++j)
+    {
+      sum_l += l[j] * coefs[j];
+      sum_r += r[j] * coefs[j];
+    }
+
+    out_left[i] = Round(sum_l);
+    out_right[i] = Round(sum_r);
+    pos += ratio;
+  }
+  return pos;
+}
+#endif
+}  // namespace Resampler
+}  // namespace AudioCommon
@@ -0,0 +1,49 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+
+#include "Common/CommonTypes.h"
+
+namespace AudioCommon
+{
+namespace Resampler
+{
+// Block resampling kernels for deinterleaved 16-bit stereo, used by the mixer.
+//
+// The input pointers point at the frame for position 0. pos is a 16.16 fixed point position in
+// the input, and is advanced by ratio after each output frame. The kernels write count frames of
+// interpolated samples, without any volume applied, to out_left and out_right, and return the
+// position after the last output frame.
+
+// Input frames that the sinc filter needs before and after the integer part of a position.
+constexpr u32 SINC_TAPS = 16;
+constexpr u32 SINC_HISTORY = SINC_TAPS / 2 - 1;
+constexpr u32 SINC_LOOKAHEAD = SINC_TAPS / 2;
+
+// Filter phases, selected by the top bits of the fractional position.
+constexpr u32 SINC_PHASE_BITS = 9;
+constexpr u32 SINC_PHASES = 1 << SINC_PHASE_BITS;
+
+// Filter coefficients in 2.14 fixed point. Each phase sums to exactly 1.0.
+struct SincTable
+{
+  alignas(16) std::array<std::array<s16, SINC_TAPS>, SINC_PHASES> phases;
+};
+
+// Builds a Blackman-windowed sinc filter. cutoff is relative to the input Nyquist frequency, and
+// must be lowered below 1.0 when downsampling to avoid aliasing.
+void BuildSincTable(SincTable* table, float cutoff);
+
+// Reads input[0 .. (pos + count * ratio) >> 16] inclusive.
+u32 ResampleLinear(const s16* left, const s16* right, s32* out_left, s32* out_right, u32 count,
+                   u32 pos, u32 ratio);
+
+// Reads SINC_HISTORY frames before and SINC_LOOKAHEAD frames after the positions.
+u32 ResampleSinc(const SincTable& table, const s16* left, const s16* right, s32* out_left,
+                 s32* out_right, u32 count, u32 pos, u32 ratio);
+}  // namespace Resampler
+}  // namespace AudioCommon
@@ -13,6 +13,7 @@
 // - Zero backwards/forwards compatibility
 // - Serialization code for anything complex has to be manually written.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstring>
@@ -70,8 +71,20 @@ public:
 
 public:
   PointerWrap(u8** ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
+  // Writes into a buffer that grows as needed, so that the state doesn't have to be measured
+  // with a separate MODE_MEASURE pass first. Call FinishWrite() once done.
+  // The buffer's capacity is kept, so reusing it for the next save avoids reallocating.
+  explicit PointerWrap(std::vector<u8>* buffer)
+      : ptr(&m_write_ptr), mode(MODE_WRITE), m_write_buffer(buffer)
+  {
+    m_write_ptr = buffer->data();
+    m_write_end = m_write_ptr + buffer->size();
+  }
+
   void SetMode(Mode mode_) { mode = mode_; }
   Mode GetMode() const { return mode; }
+  // The number of bytes written so far. Only for a PointerWrap that writes into a vector.
+  size_t GetWriteOffset() const { return m_write_ptr - m_write_buffer->data(); }
   template <typename K, class V>
   void Do(std::map<K, V>& x)
   {
@@ -265,6 +278,19 @@ public:
       member(*this, elem);
   }
 
+  // Shrinks the buffer passed to the constructor to the size of the written state.
+  // If writing was aborted (the mode is no longer MODE_WRITE), the write pointer has moved past
+  // the end of the buffer without writing anything, so the buffer is cleared instead.
+  void FinishWrite()
+  {
+    if (mode != MODE_WRITE)
+    {
+      m_write_buffer->clear();
+      return;
+    }
+    m_write_buffer->resize(m_write_ptr - m_write_buffer->data());
+  }
+
 private:
   template <typename T>
   void DoContainer(T& x)
@@ -281,6 +307,8 @@ private:
       break;
 
     case MODE_WRITE:
+      if (m_write_buffer && static_cast<size_t>(m_write_end - *ptr) < size)
+        GrowWriteBuffer(size);
       memcpy(*ptr, data, size);
       break;
 
@@ -296,4 +324,19 @@ private:
 
     *ptr += size;
   }
+
+  void GrowWriteBuffer(u32 size)
+  {
+    // Growing in small steps keeps resize() from zero-filling much memory that is about to be
+    // overwritten anyway. The vector still reallocates geometrically.
+    const size_t offset = m_write_ptr - m_write_buffer->data();
+    const size_t min_step = 1024 * 1024;
+    m_write_buffer->resize(offset + std::max<size_t>(size, min_step));
+    m_write_ptr = m_write_buffer->data() + offset;
+    m_write_end = m_write_buffer->data() + m_write_buffer->size();
+  }
+
+  std::vector<u8>* m_write_buffer = nullptr;
+  u8* m_write_ptr = nullptr;
+  u8* m_write_end = nullptr;
 };
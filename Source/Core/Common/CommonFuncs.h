@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <string>
 #include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
 
 // Will fail to compile on a non-array:
 #if defined(_MSC_VER) && _MSC_VER <= 1800
@@ -38,6 +39,7 @@ constexpr size_t ArraySize(T (&arr)[N])
 // go to debugger mode
 #define Crash()                                                                                    \
   {                                                                                                \
+    FlushLogs();                                                                                   \
     __builtin_trap();                                                                              \
   }
 
@@ -96,6 +98,7 @@ __declspec(dllimport) void __stdcall DebugBreak(void);
 }
 #define Crash()                                                                                    \
   {                                                                                                \
+    FlushLogs();                                                                                   \
     DebugBreak();                                                                                  \
   }
 
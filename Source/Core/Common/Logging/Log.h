@@ -81,6 +81,9 @@ void GenericLog(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char*
 #endif
     ;
 
+// Writes out every message that has been logged so far. Used before alerts and crashes.
+void FlushLogs();
+
 #if defined LOGGING || defined _DEBUG || defined DEBUGFAST
 #define MAX_LOGLEVEL LogTypes::LOG_LEVELS::LDEBUG
 #else
@@ -2,11 +2,16 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <cstring>
+#include <ctime>
 #include <mutex>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonPaths.h"
 #include "Common/Config/Config.h"
@@ -14,10 +19,15 @@
 #include "Common/Logging/ConsoleListener.h"
 #include "Common/Logging/Log.h"
 #include "Common/Logging/LogManager.h"
+#include "Common/Logging/LogRingBuffer.h"
+#include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
-#include "Common/Timer.h"
+#include "Common/Thread.h"
 
 constexpr size_t MAX_MSGLEN = 1024;
+// Per logging thread. Holds a few thousand typical messages.
+constexpr size_t LOG_BUFFER_SIZE = 256 * 1024;
+constexpr auto LOG_THREAD_INTERVAL = std::chrono::milliseconds(10);
 
 const Config::ConfigInfo<bool> LOGGER_WRITE_TO_FILE{
     {Config::System::Logger, "Options", "WriteToFile"}, false};
@@ -36,20 +46,25 @@ public:
     SetEnable(true);
   }
 
+  // Calls are serialized by the LogManager.
   void Log(LogTypes::LOG_LEVELS, const char* msg) override
   {
     if (!IsEnabled() || !IsValid())
       return;
 
-    std::lock_guard<std::mutex> lk(m_log_lock);
-    m_logfile << msg << std::flush;
+    m_logfile << msg;
+  }
+
+  void Flush() override
+  {
+    if (IsValid())
+      m_logfile.flush();
   }
 
   bool IsValid() const { return m_logfile.good(); }
   bool IsEnabled() const { return m_enable; }
   void SetEnable(bool enable) { m_enable = enable; }
 private:
-  std::mutex m_log_lock;
   std::ofstream m_logfile;
   bool m_enable;
 };
@@ -64,6 +79,12 @@ void GenericLog(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char*
   va_end(args);
 }
 
+void FlushLogs()
+{
+  if (LogManager::GetInstance())
+    LogManager::GetInstance()->Flush();
+}
+
 static size_t DeterminePathCutOffPoint()
 {
 #if !(defined(_MSC_VER) && _MSC_VER <= 1800)
@@ -76,7 +97,35 @@ static size_t DeterminePathCutOffPoint()
   return 0;
 }
 
-LogManager::LogManager()
+static std::atomic<u64> s_next_manager_id{1};
+
+struct ThreadLogBuffer
+{
+  std::shared_ptr<LogRingBuffer> buffer;
+  u64 manager_id = 0;
+};
+
+static thread_local ThreadLogBuffer s_thread_buffer;
+// Set while this thread hands messages to the listeners, so that a listener which logs
+// doesn't flush recursively.
+static thread_local bool s_processing_logs = false;
+
+static std::string FormatTime(s64 time_ms)
+{
+  const time_t seconds = static_cast<time_t>(time_ms / 1000);
+  struct tm local_time;
+#ifdef _WIN32
+  localtime_s(&local_time, &seconds);
+#else
+  localtime_r(&seconds, &local_time);
+#endif
+
+  char tmp[6];
+  strftime(tmp, sizeof(tmp), "%M:%S", &local_time);
+  return StringFromFormat("%s:%03d", tmp, static_cast<int>(time_ms % 1000));
+}
+
+LogManager::LogManager() : m_id(s_next_manager_id++)
 {
   // create log containers
   m_log[LogTypes::ACTIONREPLAY] = {"ActionReplay", "ActionReplay"};
@@ -152,10 +201,16 @@ LogManager::LogManager()
         Config::ConfigInfo<bool>{{Config::System::Logger, "Logs", container.m_short_name}, false});
 
   m_path_cutoff_point = DeterminePathCutOffPoint();
+
+  m_log_thread = std::thread(&LogManager::LogThread, this);
 }
 
 LogManager::~LogManager()
 {
+  m_log_thread_running.store(false);
+  m_log_event.Set();
+  m_log_thread.join();
+
   // The log window listener pointer is owned by the GUI code.
   delete m_listeners[LogListener::CONSOLE_LISTENER];
   delete m_listeners[LogListener::FILE_LISTENER];
@@ -192,13 +247,142 @@ void LogManager::LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE
   char temp[MAX_MSGLEN];
   CharArrayFromFormatV(temp, MAX_MSGLEN, format, args);
 
-  std::string msg =
-      StringFromFormat("%s %s:%u %c[%s]: %s\n", Common::Timer::GetTimeFormatted().c_str(), file,
-                       line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), temp);
+  LogRecordHeader header;
+  header.sequence = m_sequence.fetch_add(1, std::memory_order_relaxed);
+  header.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  header.file = file;
+  header.line = static_cast<u32>(line);
+  header.text_length = static_cast<u16>(strlen(temp));
+  header.level = static_cast<u8>(level);
+  header.type = static_cast<u8>(type);
+
+  LogRingBuffer* buffer = GetThreadBuffer();
+  while (!buffer->Push(header, temp))
+  {
+    // Nobody else drains the log thread's own buffer.
+    if (std::this_thread::get_id() == m_log_thread.get_id())
+      return;
+
+    m_log_event.Set();
+    std::this_thread::yield();
+  }
+
+  // Errors and notices are written out right away so that they aren't lost if the process
+  // dies before the log thread wakes up.
+  if (level <= LogTypes::LERROR)
+    Flush();
+  else if (buffer->GetUsedSize() > buffer->GetCapacity() / 2)
+    m_log_event.Set();
+}
+
+void LogManager::Flush()
+{
+  if (s_processing_logs)
+    return;
+
+  ProcessLogs();
+}
+
+LogRingBuffer* LogManager::GetThreadBuffer()
+{
+  // Buffers are tied to a LogManager instance so that a thread keeps logging correctly
+  // if the LogManager is shut down and initialized again.
+  if (s_thread_buffer.manager_id != m_id)
+  {
+    s_thread_buffer.buffer = std::make_shared<LogRingBuffer>(LOG_BUFFER_SIZE);
+    s_thread_buffer.manager_id = m_id;
+
+    std::lock_guard<std::mutex> lk(m_buffers_lock);
+    m_buffers.push_back(s_thread_buffer.buffer);
+  }
+  return s_thread_buffer.buffer.get();
+}
+
+void LogManager::LogThread()
+{
+  Common::SetCurrentThreadName("Log thread");
+
+  while (m_log_thread_running.load())
+  {
+    m_log_event.WaitFor(LOG_THREAD_INTERVAL);
+    ProcessLogs();
+  }
+
+  // Write out whatever was logged before shutdown.
+  ProcessLogs();
+}
+
+void LogManager::ProcessLogs()
+{
+  struct PendingMessage
+  {
+    LogRecordHeader header;
+    size_t text_offset;
+  };
+
+  std::lock_guard<std::mutex> process_lk(m_process_lock);
+  s_processing_logs = true;
+  Common::ScopeGuard processing_guard{[] { s_processing_logs = false; }};
+
+  std::vector<std::shared_ptr<LogRingBuffer>> buffers;
+  {
+    std::lock_guard<std::mutex> lk(m_buffers_lock);
+    buffers = m_buffers;
+  }
+
+  std::vector<PendingMessage> messages;
+  std::string text;
+  for (const auto& buffer : buffers)
+  {
+    buffer->PopAll([&](const LogRecordHeader& header, const char* msg) {
+      messages.push_back({header, text.size()});
+      text.append(msg, header.text_length);
+    });
+  }
+
+  {
+    // Once only m_buffers references a buffer, the thread that owned it has exited.
+    std::lock_guard<std::mutex> lk(m_buffers_lock);
+    buffers.clear();
+    m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                   [](const std::shared_ptr<LogRingBuffer>& buffer) {
+                                     return buffer.use_count() == 1 && buffer->IsEmpty();
+                                   }),
+                    m_buffers.end());
+  }
+
+  if (messages.empty())
+    return;
+
+  // Each thread has its own buffer, so restore the order in which messages were logged.
+  // This only orders messages within one batch: a message whose sequence number was taken
+  // just before the buffers were drained but which was pushed afterwards is written in the
+  // next batch, after messages that were logged later.
+  std::sort(messages.begin(), messages.end(),
+            [](const PendingMessage& a, const PendingMessage& b) {
+              return a.header.sequence < b.header.sequence;
+            });
+
+  for (const PendingMessage& message : messages)
+  {
+    const LogRecordHeader& header = message.header;
+    const auto level = static_cast<LogTypes::LOG_LEVELS>(header.level);
+    std::string msg = StringFromFormat(
+        "%s %s:%u %c[%s]: %.*s\n", FormatTime(header.time_ms).c_str(), header.file, header.line,
+        LogTypes::LOG_LEVEL_TO_CHAR[header.level],
+        GetShortName(static_cast<LogTypes::LOG_TYPE>(header.type)),
+        static_cast<int>(header.text_length), text.data() + message.text_offset);
+
+    for (auto listener_id : m_listener_ids)
+      if (m_listeners[listener_id])
+        m_listeners[listener_id]->Log(level, msg.c_str());
+  }
 
   for (auto listener_id : m_listener_ids)
     if (m_listeners[listener_id])
-      m_listeners[listener_id]->Log(level, msg.c_str());
+      m_listeners[listener_id]->Flush();
 }
 
 LogTypes::LOG_LEVELS LogManager::GetLogLevel() const
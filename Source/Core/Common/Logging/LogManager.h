@@ -5,17 +5,29 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Common/BitSet.h"
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/Logging/Log.h"
 
+class LogRingBuffer;
+
 // pure virtual interface
 class LogListener
 {
 public:
   virtual ~LogListener() {}
   virtual void Log(LogTypes::LOG_LEVELS, const char* msg) = 0;
+  // Called after each batch of messages. Batches are delivered one at a time, either on the
+  // log thread or on a thread that flushes the logs.
+  virtual void Flush() {}
 
   enum LISTENER
   {
@@ -36,8 +48,11 @@ public:
 
   void Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
            const char* fmt, va_list args);
+  // file must stay valid until the message has been written, which __FILE__ always does.
   void LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
                        int line, const char* fmt, va_list args);
+  // Hands every message pushed so far to the listeners and flushes them before returning.
+  void Flush();
 
   LogTypes::LOG_LEVELS GetLogLevel() const;
   void SetLogLevel(LogTypes::LOG_LEVELS level);
@@ -70,6 +85,10 @@ private:
   LogManager();
   ~LogManager();
 
+  LogRingBuffer* GetThreadBuffer();
+  void LogThread();
+  void ProcessLogs();
+
   LogManager(const LogManager&) = delete;
   LogManager& operator=(const LogManager&) = delete;
   LogManager(LogManager&&) = delete;
@@ -80,4 +99,15 @@ private:
   std::array<LogListener*, LogListener::NUMBER_OF_LISTENERS> m_listeners;
   BitSet32 m_listener_ids;
   size_t m_path_cutoff_point = 0;
+
+  // Messages are pushed into a ring owned by the thread that logs them and handed to the
+  // listeners on m_log_thread, so that logging doesn't stall the emulation threads.
+  const u64 m_id;
+  std::atomic<u64> m_sequence{0};
+  std::mutex m_buffers_lock;
+  std::vector<std::shared_ptr<LogRingBuffer>> m_buffers;
+  std::mutex m_process_lock;
+  std::thread m_log_thread;
+  std::atomic<bool> m_log_thread_running{true};
+  Common::Event m_log_event;
 };
@@ -0,0 +1,130 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a bounded lockless single writer, single reader ring buffer
+// of variable-length log records
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include "Common/CommonTypes.h"
+
+struct LogRecordHeader
+{
+  u64 sequence;
+  s64 time_ms;
+  const char* file;
+  u32 line;
+  u16 text_length;
+  u8 level;
+  u8 type;
+};
+
+class LogRingBuffer final
+{
+public:
+  explicit LogRingBuffer(size_t capacity)
+      : m_capacity((capacity + ALIGNMENT - 1) & ~(ALIGNMENT - 1)), m_buffer(new u8[m_capacity])
+  {
+    // If a record doesn't fit before the end of the buffer, the writer skips the rest of it.
+    // That gap either holds a wrap marker or is too small for a header, and the reader
+    // recognizes both the same way.
+    static_assert(sizeof(LogRecordHeader) % ALIGNMENT == 0, "Header size must be aligned");
+  }
+
+  LogRingBuffer(const LogRingBuffer&) = delete;
+  LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+  // Writer thread only. Returns false if there isn't enough free space; the record is
+  // not written at all in that case.
+  bool Push(const LogRecordHeader& header, const char* text)
+  {
+    const size_t size = RecordSize(header.text_length);
+    const size_t write = m_write_pos.load(std::memory_order_relaxed);
+    const size_t read = m_read_pos.load(std::memory_order_acquire);
+    const size_t offset = write % m_capacity;
+    const size_t contiguous = m_capacity - offset;
+    const size_t skip = size > contiguous ? contiguous : 0;
+
+    if (m_capacity - (write - read) < skip + size)
+      return false;
+
+    if (skip >= sizeof(LogRecordHeader))
+    {
+      LogRecordHeader marker{};
+      marker.text_length = WRAP_MARKER;
+      std::memcpy(&m_buffer[offset], &marker, sizeof(marker));
+    }
+
+    u8* const record = &m_buffer[(write + skip) % m_capacity];
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), text, header.text_length);
+    m_write_pos.store(write + skip + size, std::memory_order_release);
+    return true;
+  }
+
+  // Reader thread only. Calls func(header, text) for every record that was pushed so far.
+  // The text is not null-terminated and is only valid during the call.
+  template <typename Func>
+  size_t PopAll(Func&& func)
+  {
+    size_t read = m_read_pos.load(std::memory_order_relaxed);
+    const size_t write = m_write_pos.load(std::memory_order_acquire);
+    size_t count = 0;
+
+    while (read != write)
+    {
+      const size_t offset = read % m_capacity;
+      const size_t contiguous = m_capacity - offset;
+      LogRecordHeader header;
+      if (contiguous < sizeof(header))
+      {
+        read += contiguous;
+        continue;
+      }
+
+      std::memcpy(&header, &m_buffer[offset], sizeof(header));
+      if (header.text_length == WRAP_MARKER)
+      {
+        read += contiguous;
+        continue;
+      }
+
+      func(header, reinterpret_cast<const char*>(&m_buffer[offset + sizeof(header)]));
+      read += RecordSize(header.text_length);
+      ++count;
+    }
+
+    m_read_pos.store(read, std::memory_order_release);
+    return count;
+  }
+
+  // Approximate when called from the writer thread, which is all it is used for.
+  size_t GetUsedSize() const
+  {
+    return m_write_pos.load(std::memory_order_relaxed) -
+           m_read_pos.load(std::memory_order_relaxed);
+  }
+
+  size_t GetCapacity() const { return m_capacity; }
+  bool IsEmpty() const { return GetUsedSize() == 0; }
+
+private:
+  static constexpr size_t ALIGNMENT = 8;
+  static constexpr u16 WRAP_MARKER = 0xFFFF;
+
+  static size_t RecordSize(size_t text_length)
+  {
+    return (sizeof(LogRecordHeader) + text_length + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  const size_t m_capacity;
+  std::unique_ptr<u8[]> m_buffer;
+  std::atomic<size_t> m_write_pos{0};
+  std::atomic<size_t> m_read_pos{0};
+};
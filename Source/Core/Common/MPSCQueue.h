@@ -0,0 +1,98 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a bounded lockless thread-safe,
+// multiple writer, single reader queue
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+template <typename T, size_t Capacity>
+class MPSCQueue
+{
+  static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+public:
+  MPSCQueue()
+  {
+    for (size_t i = 0; i < Capacity; ++i)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // Can be called from any thread. Returns false if the queue is full.
+  template <typename Arg>
+  bool Push(Arg&& t)
+  {
+    size_t pos = m_write_pos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+      cell = &m_cells[pos & (Capacity - 1)];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const s64 difference = static_cast<s64>(sequence) - static_cast<s64>(pos);
+
+      // The cell is free, try to claim it.
+      if (difference == 0)
+      {
+        if (m_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      }
+      // The reader hasn't popped the element that was written here a lap ago.
+      else if (difference < 0)
+      {
+        return false;
+      }
+      // Another writer claimed the cell first.
+      else
+      {
+        pos = m_write_pos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::forward<Arg>(t);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Only the reader thread may call the functions below.
+  bool Empty() const
+  {
+    const Cell& cell = m_cells[m_read_pos & (Capacity - 1)];
+    return cell.sequence.load(std::memory_order_acquire) != m_read_pos + 1;
+  }
+
+  bool Pop(T& t)
+  {
+    Cell& cell = m_cells[m_read_pos & (Capacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != m_read_pos + 1)
+      return false;
+
+    t = std::move(cell.value);
+    cell.sequence.store(m_read_pos + Capacity, std::memory_order_release);
+    ++m_read_pos;
+    return true;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::array<Cell, Capacity> m_cells;
+  // Keep the writers' and the reader's positions on separate cache lines.
+  alignas(64) std::atomic<size_t> m_write_pos{0};
+  alignas(64) size_t m_read_pos = 0;
+};
+}
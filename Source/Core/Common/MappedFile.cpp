@@ -0,0 +1,129 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "Common/StringUtil.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace File
+{
+MappedFile::MappedFile(const std::string& filename)
+{
+  Open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+  Close();
+
+#ifdef _WIN32
+  // Other handles may write to the file, so that files which are still being appended to
+  // can be mapped up to their current size.
+  HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  // The mapping keeps the file open.
+  m_mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!m_mapping)
+    return false;
+
+  m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!m_data)
+  {
+    Close();
+    return false;
+  }
+  m_size = static_cast<u64>(size.QuadPart);
+#else
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // The mapping keeps the file open.
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  m_data = static_cast<const u8*>(data);
+  m_size = static_cast<u64>(st.st_size);
+#endif
+
+  return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+  if (m_data)
+    UnmapViewOfFile(m_data);
+  if (m_mapping)
+    CloseHandle(m_mapping);
+  m_mapping = nullptr;
+#else
+  if (m_data)
+    munmap(const_cast<u8*>(m_data), m_size);
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+const u8* MappedFile::GetPointer(u64 offset, u64 size) const
+{
+  if (offset > m_size || size > m_size - offset)
+    return nullptr;
+
+  return m_data + offset;
+}
+
+void MappedFile::Release(u64 offset, u64 size) const
+{
+  if (!GetPointer(offset, size) || size == 0)
+    return;
+
+  // Whole pages are released. The mapping is read-only, so releasing parts of other ranges on
+  // the same pages only means that they are read again.
+#ifdef _WIN32
+  // Unlocking pages that aren't locked removes them from the working set.
+  VirtualUnlock(const_cast<u8*>(m_data + offset), size);
+#else
+  const u64 page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+  const u64 start = offset & ~(page_size - 1);
+  madvise(const_cast<u8*>(m_data + start), offset + size - start, MADV_DONTNEED);
+#endif
+}
+}  // namespace File
@@ -0,0 +1,47 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace File
+{
+// A read-only memory mapping of a whole file. Pages are only read from disk when they are
+// accessed, so large files can be opened without reading them into memory.
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Fails for empty files.
+  bool Open(const std::string& filename);
+  void Close();
+
+  bool IsOpen() const { return m_data != nullptr; }
+  const u8* GetData() const { return m_data; }
+  u64 GetSize() const { return m_size; }
+
+  // Returns a pointer to the given range, or nullptr if it's not entirely in the file.
+  const u8* GetPointer(u64 offset, u64 size) const;
+
+  // Hints that the given range won't be accessed soon, so that its pages can be dropped from
+  // the resident set. They're read again when they're next accessed.
+  void Release(u64 offset, u64 size) const;
+
+private:
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+#ifdef _WIN32
+  void* m_mapping = nullptr;
+#endif
+};
+}  // namespace File
@@ -90,6 +90,8 @@ bool MsgAlert(bool yes_no, MsgType style, const char* format, ...)
   va_end(args);
 
   ERROR_LOG(MASTER_LOG, "%s: %s", caption.c_str(), buffer);
+  // The alert may be the last thing the user sees before the process goes away.
+  FlushLogs();
 
   // Don't ignore questions, especially AskYesNo, PanicYesNo could be ignored
   if (msg_handler && (AlertEnabled || style == MsgType::Question || style == MsgType::Critical))
@@ -0,0 +1,107 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a bounded lockless ring buffer of trivially copyable elements,
+// single writer, single reader
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace Common
+{
+template <typename T, size_t Capacity>
+class SPSCRingBuffer
+{
+  static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+  static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+public:
+  static constexpr size_t CAPACITY = Capacity;
+
+  // Only the writer thread may call the functions below.
+
+  // Copies as many of the count elements as fit, and returns how many were copied. Never waits
+  // for the reader.
+  size_t Push(const T* data, size_t count)
+  {
+    return Push(data, count, [](const T* in, const T* in_end, T* out) {
+      std::memcpy(out, in, (in_end - in) * sizeof(T));
+    });
+  }
+
+  // Like Push, but copies with copy(const T* begin, const T* end, T* out), which can convert the
+  // elements on the way, e.g. std::transform with a byte swap.
+  template <typename Copy>
+  size_t Push(const T* data, size_t count, Copy copy)
+  {
+    const size_t write_pos = m_write_pos.load(std::memory_order_relaxed);
+    if (Capacity - (write_pos - m_cached_read_pos) < count)
+      m_cached_read_pos = m_read_pos.load(std::memory_order_acquire);
+    count = std::min(count, Capacity - (write_pos - m_cached_read_pos));
+
+    const size_t start = write_pos & (Capacity - 1);
+    const size_t first_part = std::min(count, Capacity - start);
+    copy(data, data + first_part, &m_buffer[start]);
+    copy(data + first_part, data + count, &m_buffer[0]);
+
+    m_write_pos.store(write_pos + count, std::memory_order_release);
+    return count;
+  }
+
+  // Number of elements that can be read. Can be called from any thread, but is only exact on the
+  // reader thread.
+  size_t Size() const
+  {
+    // Load the read position first, so that it can't be newer than the write position.
+    const size_t read_pos = m_read_pos.load(std::memory_order_acquire);
+    return m_write_pos.load(std::memory_order_acquire) - read_pos;
+  }
+
+  // Only the reader thread may call the functions below.
+
+  // Copies up to count elements, starting offset elements after the read position, without
+  // removing them. Returns how many were copied.
+  size_t Peek(T* out, size_t count, size_t offset = 0) const
+  {
+    const size_t read_pos = m_read_pos.load(std::memory_order_relaxed);
+    const size_t size = m_write_pos.load(std::memory_order_acquire) - read_pos;
+    if (offset >= size)
+      return 0;
+    count = std::min(count, size - offset);
+
+    const size_t start = (read_pos + offset) & (Capacity - 1);
+    const size_t first_part = std::min(count, Capacity - start);
+    std::memcpy(out, &m_buffer[start], first_part * sizeof(T));
+    std::memcpy(out + first_part, &m_buffer[0], (count - first_part) * sizeof(T));
+    return count;
+  }
+
+  // Removes up to count elements, and returns how many were removed.
+  size_t Discard(size_t count)
+  {
+    const size_t read_pos = m_read_pos.load(std::memory_order_relaxed);
+    count = std::min(count, m_write_pos.load(std::memory_order_acquire) - read_pos);
+    m_read_pos.store(read_pos + count, std::memory_order_release);
+    return count;
+  }
+
+  size_t Pop(T* out, size_t count) { return Discard(Peek(out, count)); }
+
+private:
+  std::array<T, Capacity> m_buffer;
+  // Keep the writer's and the reader's positions on separate cache lines. The writer also keeps
+  // the last read position it has seen, so that it only touches the reader's cache line when the
+  // buffer looks full.
+  alignas(64) std::atomic<size_t> m_write_pos{0};
+  size_t m_cached_read_pos = 0;
+  alignas(64) std::atomic<size_t> m_read_pos{0};
+};
+}
@@ -0,0 +1,109 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Common/Thread.h"
+
+// A fixed number of threads that execute the tasks placed into a shared queue.
+// Tasks that haven't started when the pool is destroyed are dropped; their futures
+// report std::future_errc::broken_promise.
+
+namespace Common
+{
+class ThreadPool
+{
+public:
+  ThreadPool() = default;
+  ThreadPool(size_t num_threads, const std::string& name) { Reset(num_threads, name); }
+  ~ThreadPool() { Shutdown(); }
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void Reset(size_t num_threads, const std::string& name)
+  {
+    Shutdown();
+    m_shutdown = false;
+    for (size_t i = 0; i < num_threads; ++i)
+      m_threads.emplace_back([this, name] { ThreadLoop(name); });
+  }
+
+  size_t GetThreadCount() const { return m_threads.size(); }
+
+  // Returns a sensible number of worker threads for work that runs next to the emulator:
+  // one per core, minus the calling thread, capped at max_threads.
+  static size_t GetDefaultThreadCount(size_t max_threads)
+  {
+    const size_t cores = std::thread::hardware_concurrency();
+    return std::min<size_t>(cores > 1 ? cores - 1 : 0, max_threads);
+  }
+
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> Schedule(F&& function)
+  {
+    using Result = typename std::result_of<F()>::type;
+    // std::function needs a copyable target, so the task is shared.
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+    std::future<Result> future = task->get_future();
+    {
+      std::lock_guard<std::mutex> lg(m_lock);
+      m_tasks.emplace_back([task] { (*task)(); });
+    }
+    m_wakeup.notify_one();
+    return future;
+  }
+
+private:
+  void Shutdown()
+  {
+    {
+      std::lock_guard<std::mutex> lg(m_lock);
+      m_shutdown = true;
+      m_tasks.clear();
+    }
+    m_wakeup.notify_all();
+    for (std::thread& thread : m_threads)
+      thread.join();
+    m_threads.clear();
+  }
+
+  void ThreadLoop(const std::string& name)
+  {
+    SetCurrentThreadName(name.c_str());
+
+    while (true)
+    {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lg(m_lock);
+        m_wakeup.wait(lg, [this] { return m_shutdown || !m_tasks.empty(); });
+        if (m_shutdown)
+          break;
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> m_threads;
+  std::condition_variable m_wakeup;
+  std::mutex m_lock;
+  std::deque<std::function<void()>> m_tasks;
+  bool m_shutdown = false;
+};
+
+}  // namespace Common
@@ -333,6 +333,7 @@ void SConfig::SaveGeneralSettings(IniFile& ini)
   general->Set("LastFilename", m_LastFilename);
   general->Set("ShowLag", m_ShowLag);
   general->Set("ShowFrameCount", m_ShowFrameCount);
+  general->Set("ShowAudioStats", m_ShowAudioStats);
 
   // ISO folders
   // Clear removed folders
@@ -500,6 +501,7 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("TimingVariance", iTimingVariance);
   core->Set("CPUCore", iCPUCore);
   core->Set("Fastmem", bFastmem);
+  core->Set("JITWarmStart", bJITWarmStart);
   core->Set("CPUThread", bCPUThread);
   core->Set("DSPHLE", bDSPHLE);
   core->Set("SkipIdle", bSkipIdle);
@@ -512,12 +514,16 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("AccurateNaNs", bAccurateNaNs);
   core->Set("DefaultISO", m_strDefaultISO);
   core->Set("EnableCheats", bEnableCheats);
+  core->Set("EnableRewind", bEnableRewind);
+  core->Set("RewindBufferSize", iRewindBufferSize);
+  core->Set("SavestateCodec", m_strSavestateCodec);
   core->Set("SelectedLanguage", SelectedLanguage);
   core->Set("OverrideGCLang", bOverrideGCLanguage);
   core->Set("DPL2Decoder", bDPL2Decoder);
   core->Set("AudioLatency", iLatency);
   core->Set("AudioStretch", m_audio_stretch);
   core->Set("AudioStretchMaxLatency", m_audio_stretch_max_latency);
+  core->Set("AudioSincResampling", m_audio_sinc_resampling);
   core->Set("MemcardAPath", m_strMemoryCardA);
   core->Set("MemcardBPath", m_strMemoryCardB);
   core->Set("AgpCartAPath", m_strGbaCartA);
@@ -575,6 +581,7 @@ void SConfig::SaveDSPSettings(IniFile& ini)
     dsp->Set("Backend", sBackend);
   dsp->Set("Volume", m_Volume);
   dsp->Set("CaptureLog", m_DSPCaptureLog);
+  dsp->Set("PolyphaseResampling", m_DSPPolyphaseResampling);
 }
 
 void SConfig::SaveInputSettings(IniFile& ini)
@@ -666,6 +673,7 @@ void SConfig::LoadGeneralSettings(IniFile& ini)
   general->Get("LastFilename", &m_LastFilename);
   general->Get("ShowLag", &m_ShowLag, false);
   general->Get("ShowFrameCount", &m_ShowFrameCount, false);
+  general->Get("ShowAudioStats", &m_ShowAudioStats, false);
 #ifdef USE_GDBSTUB
 #ifndef _WIN32
   general->Get("GDBSocket", &gdb_socket, "");
@@ -871,6 +879,7 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
   core->Get("Fastmem", &bFastmem, true);
+  core->Get("JITWarmStart", &bJITWarmStart, false);
   core->Get("DSPHLE", &bDSPHLE, true);
   core->Get("TimingVariance", &iTimingVariance, 40);
   core->Get("CPUThread", &bCPUThread, true);
@@ -878,12 +887,16 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("SyncOnSkipIdle", &bSyncGPUOnSkipIdleHack, true);
   core->Get("DefaultISO", &m_strDefaultISO);
   core->Get("EnableCheats", &bEnableCheats, false);
+  core->Get("EnableRewind", &bEnableRewind, false);
+  core->Get("RewindBufferSize", &iRewindBufferSize, 256);
+  core->Get("SavestateCodec", &m_strSavestateCodec, "LZO");
   core->Get("SelectedLanguage", &SelectedLanguage, 0);
   core->Get("OverrideGCLang", &bOverrideGCLanguage, false);
   core->Get("DPL2Decoder", &bDPL2Decoder, false);
   core->Get("AudioLatency", &iLatency, 20);
   core->Get("AudioStretch", &m_audio_stretch, false);
   core->Get("AudioStretchMaxLatency", &m_audio_stretch_max_latency, 80);
+  core->Get("AudioSincResampling", &m_audio_sinc_resampling, true);
   core->Get("MemcardAPath", &m_strMemoryCardA);
   core->Get("MemcardBPath", &m_strMemoryCardB);
   core->Get("AgpCartAPath", &m_strGbaCartA);
@@ -958,6 +971,7 @@ void SConfig::LoadDSPSettings(IniFile& ini)
   dsp->Get("Backend", &sBackend, AudioCommon::GetDefaultSoundBackend());
   dsp->Get("Volume", &m_Volume, 100);
   dsp->Get("CaptureLog", &m_DSPCaptureLog, false);
+  dsp->Get("PolyphaseResampling", &m_DSPPolyphaseResampling, false);
 
   if (ARBruteForcer::ch_bruteforce)
     sBackend = BACKEND_NULLSOUND;
@@ -1146,6 +1160,7 @@ void SConfig::LoadDefaults()
   iLatency = 20;
   m_audio_stretch = false;
   m_audio_stretch_max_latency = 80;
+  m_audio_sinc_resampling = true;
 
   iPosX = INT_MIN;
   iPosY = INT_MIN;
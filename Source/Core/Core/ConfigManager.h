@@ -82,6 +82,7 @@ struct SConfig
   int iCPUCore;  // Uses the values of PowerPC::CPUCore
 
   bool bJITNoBlockCache = false;
+  bool bJITWarmStart = false;
   bool bJITNoBlockLinking = false;
   bool bJITOff = false;
   bool bJITLoadStoreOff = false;
@@ -108,6 +109,9 @@ struct SConfig
   bool bSyncGPUOnSkipIdleHack = true;
   bool bHLE_BS2 = true;
   bool bEnableCheats = false;
+  bool bEnableRewind = false;
+  int iRewindBufferSize = 256;  // in MiB
+  std::string m_strSavestateCodec = "LZO";  // "LZO" or "zlib"
   bool bEnableMemcardSdWriting = true;
   bool bCopyWiiSaveNetplay = true;
   float fAudioSlowDown;
@@ -116,6 +120,7 @@ struct SConfig
   int iLatency = 20;
   bool m_audio_stretch = false;
   int m_audio_stretch_max_latency = 80;
+  bool m_audio_sinc_resampling = true;
 
   bool bRunCompareServer = false;
   bool bRunCompareClient = false;
@@ -150,15 +155,12 @@ struct SConfig
   float fFreeLookSensitivity;
 
   // Remove Layer
-  std::vector<SkipEntry> object_removal_codes;
   u32 skip_objects_end = 0;
   u32 skip_objects_start = 0;
 #ifdef DEBUG_OBJECTS
   u32 skip_objects_end_two = 0;
   u32 skip_objects_start_two = 0;
 #endif
-  volatile bool hide_objects_updating = true;
-  volatile bool hide_objects_done = true;
 
   // Display settings
   std::string strFullscreenResolution;
@@ -310,6 +312,7 @@ struct SConfig
   bool m_ShowLag;
   bool m_ShowFrameCount;
   bool m_ShowRTC;
+  bool m_ShowAudioStats;
   std::string m_strMovieAuthor;
   unsigned int m_FrameSkip;
   bool m_DumpFrames;
@@ -323,6 +326,9 @@ struct SConfig
   // DSP settings
   bool m_DSPEnableJIT;
   bool m_DSPCaptureLog;
+  // Use the 4-tap polyphase filter from the DSP DROM when an AX voice asks for it, instead of
+  // linear interpolation. Off by default until it has been checked against hardware.
+  bool m_DSPPolyphaseResampling;
   bool m_DumpAudio;
   bool m_DumpAudioSilent;
   bool m_IsMuted;
@@ -5,6 +5,8 @@
 #include "Core/CoreTiming.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <mutex>
 #include <string>
@@ -12,14 +14,16 @@
 #include <vector>
 
 #include "Common/Assert.h"
+#include "Common/BitSet.h"
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
 #include "Common/Logging/Log.h"
+#include "Common/MPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
 
 #include "VideoCommon/Fifo.h"
@@ -31,6 +35,10 @@ struct EventType
 {
   TimedCallback callback;
   const std::string* name;
+  // Events of this type with a lower fifo_order have been cancelled by RemoveEvent().
+  u64 removed_before;
+  // Number of events of this type in the queue that haven't been cancelled.
+  u32 pending;
 };
 
 struct Event
@@ -51,19 +59,249 @@ static bool operator<(const Event& left, const Event& right)
   return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
+// The event queue is a timing wheel. Events due within NUM_SLOTS slots of the wheel's base slot
+// are kept in a sorted bucket per slot, so scheduling the frequent short-horizon events and
+// popping the next one doesn't get more expensive with the number of pending events. Events
+// further in the future wait in an overflow min-heap until the wheel reaches them.
+//
+// RemoveEvent() doesn't search the queue. It only marks every pending event of the type as
+// cancelled, and cancelled events are dropped once they reach the front of the queue (or when
+// they start making up most of it).
+class EventQueue
+{
+public:
+  bool Empty() const { return m_size == m_cancelled; }
+  void Push(const Event& ev);
+  // Returns the earliest event that hasn't been cancelled, or nullptr if there is none.
+  const Event* Front();
+  // Must only be called after Front() returned an event.
+  Event PopFront();
+  // Cancels all the queued events of the given type. next_fifo_order is the fifo_order that the
+  // next scheduled event will get.
+  void Cancel(EventType* event_type, u64 next_fifo_order);
+  // Removes all events, and moves the base of the wheel to the current time.
+  void Clear();
+  // Returns all the events that haven't been cancelled, in no particular order.
+  std::vector<Event> GetEvents() const;
+  // Re-inserts all events after their times have been changed.
+  template <typename Functor>
+  void ModifyEvents(Functor modify);
+
+private:
+  static constexpr int SLOT_SHIFT = 10;
+  static constexpr u32 NUM_SLOTS = 256;
+  static constexpr u32 SLOT_MASK = NUM_SLOTS - 1;
+
+  static s64 GetSlot(s64 time) { return time >> SLOT_SHIFT; }
+  static bool IsCancelled(const Event& ev) { return ev.fifo_order < ev.type->removed_before; }
+  void Insert(const Event& ev);
+  void InsertIntoSlot(s64 slot, const Event& ev);
+  void PopFromSlot(u32 index);
+  // Moves the base of the wheel forward. All slots before new_base must be empty.
+  void AdvanceBase(s64 new_base);
+  u32 FindFirstOccupiedSlot() const;
+  void Compact();
+
+  // Each bucket is sorted latest first, so the next event can be popped from the back.
+  std::array<std::vector<Event>, NUM_SLOTS> m_slots;
+  std::array<u64, NUM_SLOTS / 64> m_occupied{};
+  std::vector<Event> m_overflow;
+  s64 m_base_slot = 0;
+  size_t m_wheel_size = 0;
+  // Total number of events, including cancelled ones.
+  size_t m_size = 0;
+  size_t m_cancelled = 0;
+};
+
+void EventQueue::Push(const Event& ev)
+{
+  ++ev.type->pending;
+  Insert(ev);
+}
+
+void EventQueue::Insert(const Event& ev)
+{
+  ++m_size;
+
+  // Events that are already due go into the base slot. They still come out in the right order
+  // because buckets are sorted.
+  const s64 slot = std::max(GetSlot(ev.time), m_base_slot);
+  if (slot - m_base_slot < NUM_SLOTS)
+  {
+    InsertIntoSlot(slot, ev);
+  }
+  else
+  {
+    m_overflow.push_back(ev);
+    std::push_heap(m_overflow.begin(), m_overflow.end(), std::greater<Event>());
+  }
+}
+
+void EventQueue::InsertIntoSlot(s64 slot, const Event& ev)
+{
+  const u32 index = static_cast<u32>(slot) & SLOT_MASK;
+  std::vector<Event>& bucket = m_slots[index];
+  bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), ev, std::greater<Event>()), ev);
+  m_occupied[index / 64] |= UINT64_C(1) << (index % 64);
+  ++m_wheel_size;
+}
+
+void EventQueue::PopFromSlot(u32 index)
+{
+  std::vector<Event>& bucket = m_slots[index];
+  bucket.pop_back();
+  if (bucket.empty())
+    m_occupied[index / 64] &= ~(UINT64_C(1) << (index % 64));
+  --m_wheel_size;
+  --m_size;
+}
+
+void EventQueue::AdvanceBase(s64 new_base)
+{
+  m_base_slot = new_base;
+
+  // Pull in the overflow events which now fall within the wheel.
+  while (!m_overflow.empty() && GetSlot(m_overflow.front().time) - m_base_slot < NUM_SLOTS)
+  {
+    std::pop_heap(m_overflow.begin(), m_overflow.end(), std::greater<Event>());
+    InsertIntoSlot(std::max(GetSlot(m_overflow.back().time), m_base_slot), m_overflow.back());
+    m_overflow.pop_back();
+  }
+}
+
+u32 EventQueue::FindFirstOccupiedSlot() const
+{
+  constexpr u32 NUM_WORDS = NUM_SLOTS / 64;
+  const u32 start = static_cast<u32>(m_base_slot) & SLOT_MASK;
+
+  // Scan from the base slot to the end of the wheel, then wrap around to the slots before it.
+  for (u32 i = 0; i <= NUM_WORDS; ++i)
+  {
+    const u32 word_index = (start / 64 + i) % NUM_WORDS;
+    u64 word = m_occupied[word_index];
+    if (i == 0)
+      word &= ~UINT64_C(0) << (start % 64);
+    else if (i == NUM_WORDS)
+      word &= (UINT64_C(1) << (start % 64)) - 1;
+
+    if (word)
+      return word_index * 64 + LeastSignificantSetBit(word);
+  }
+
+  return NUM_SLOTS;
+}
+
+const Event* EventQueue::Front()
+{
+  while (m_size != 0)
+  {
+    if (m_wheel_size == 0)
+      AdvanceBase(GetSlot(m_overflow.front().time));
+
+    const u32 index = FindFirstOccupiedSlot();
+    const u32 base_index = static_cast<u32>(m_base_slot) & SLOT_MASK;
+    if (index != base_index)
+      AdvanceBase(m_base_slot + ((index - base_index) & SLOT_MASK));
+
+    const Event& ev = m_slots[index].back();
+    if (!IsCancelled(ev))
+      return &ev;
+
+    PopFromSlot(index);
+    --m_cancelled;
+  }
+
+  return nullptr;
+}
+
+Event EventQueue::PopFront()
+{
+  // Front() has moved the base of the wheel to the slot containing the earliest event.
+  const u32 index = static_cast<u32>(m_base_slot) & SLOT_MASK;
+  Event ev = m_slots[index].back();
+  PopFromSlot(index);
+  --ev.type->pending;
+  return ev;
+}
+
+void EventQueue::Cancel(EventType* event_type, u64 next_fifo_order)
+{
+  if (event_type->pending == 0)
+    return;
+
+  event_type->removed_before = next_fifo_order;
+  m_cancelled += event_type->pending;
+  event_type->pending = 0;
+
+  if (m_cancelled > 64 && m_cancelled > m_size / 2)
+    Compact();
+}
+
+void EventQueue::Clear()
+{
+  for (std::vector<Event>& bucket : m_slots)
+    bucket.clear();
+  m_occupied.fill(0);
+  m_overflow.clear();
+  m_wheel_size = 0;
+  m_size = 0;
+  m_cancelled = 0;
+
+  // The time can go backwards, e.g. when a savestate is loaded. Keeping the old base would put
+  // every event before it into the base slot until the time catches up again.
+  m_base_slot = GetSlot(g.global_timer);
+}
+
+std::vector<Event> EventQueue::GetEvents() const
+{
+  std::vector<Event> events;
+  events.reserve(m_size - m_cancelled);
+  for (const std::vector<Event>& bucket : m_slots)
+  {
+    std::copy_if(bucket.begin(), bucket.end(), std::back_inserter(events),
+                 [](const Event& ev) { return !IsCancelled(ev); });
+  }
+  std::copy_if(m_overflow.begin(), m_overflow.end(), std::back_inserter(events),
+               [](const Event& ev) { return !IsCancelled(ev); });
+  return events;
+}
+
+template <typename Functor>
+void EventQueue::ModifyEvents(Functor modify)
+{
+  std::vector<Event> events = GetEvents();
+  Clear();
+  for (Event& ev : events)
+  {
+    modify(ev);
+    Insert(ev);
+  }
+}
+
+void EventQueue::Compact()
+{
+  ModifyEvents([](Event&) {});
+}
+
 // unordered_map stores each element separately as a linked list node so pointers to elements
 // remain stable regardless of rehashes/resizing.
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
-static std::vector<Event> s_event_queue;
+static EventQueue s_event_queue;
 static u64 s_event_fifo_id;
-static std::mutex s_ts_write_lock;
-static Common::FifoQueue<Event, false> s_ts_queue;
+// Events scheduled from other threads, moved into s_event_queue by the CPU thread in MoveEvents.
+// Their fifo_order is taken from s_ts_sequence when they are scheduled, and only replaced by one
+// from s_event_fifo_id once they are moved.
+static Common::MPSCQueue<Event, 1024> s_ts_queue;
+static std::atomic<u64> s_ts_sequence{0};
+// Only used when s_ts_queue is full. While s_ts_overflowed is set, other threads keep adding to
+// the overflow so that the CPU thread sees their events in the order they were scheduled.
+static std::mutex s_ts_overflow_lock;
+static std::vector<Event> s_ts_overflow;
+static std::atomic<bool> s_ts_overflowed{false};
+// Scratch space for MoveEvents.
+static std::vector<Event> s_ts_moved_events;
 
 static float s_last_OC_factor;
 #if defined(_MSC_VER) && _MSC_VER <= 1800
@@ -76,6 +314,9 @@ static constexpr int MAX_SLICE_LENGTH = 20000;
 #endif
 
 static s64 s_idled_cycles;
+// Set when the CPU idled during the last slice. The idle time is used to compile
+// blocks ahead of time.
+static bool s_was_idle;
 static u32 s_fake_dec_start_value;
 static u64 s_fake_dec_start_ticks;
 
@@ -116,7 +357,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
                "during Init to avoid breaking save states.",
                name.c_str());
 
-  auto info = s_event_types.emplace(name, EventType{callback, nullptr});
+  auto info = s_event_types.emplace(name, EventType{callback, nullptr, 0, 0});
   EventType* event_type = &info.first->second;
   event_type->name = &info.first->first;
   return event_type;
@@ -124,7 +365,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-  _assert_msg_(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+  _assert_msg_(POWERPC, s_event_queue.Empty(), "Cannot unregister events with events pending");
   s_event_types.clear();
 }
 
@@ -136,6 +377,7 @@ void Init()
   g.slice_length = MAX_SLICE_LENGTH;
   g.global_timer = 0;
   s_idled_cycles = 0;
+  s_was_idle = false;
 
   // The time between CoreTiming being intialized and the first call to Advance() is considered
   // the slice boundary between slice -1 and slice 0. Dispatcher loops must call Advance() before
@@ -144,12 +386,12 @@ void Init()
   s_is_global_timer_sane = true;
 
   s_event_fifo_id = 0;
+  ClearPendingEvents();
   s_ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
 void Shutdown()
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
   MoveEvents();
   ClearPendingEvents();
   UnregisterAllEvents();
@@ -157,7 +399,6 @@ void Shutdown()
 
 void DoState(PointerWrap& p)
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
   p.Do(g.slice_length);
   p.Do(g.global_timer);
   p.Do(s_idled_cycles);
@@ -172,7 +413,11 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingData");
 
   MoveEvents();
-  p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+  std::vector<Event> events;
+  if (p.GetMode() != PointerWrap::MODE_READ)
+    events = s_event_queue.GetEvents();
+
+  p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
 
@@ -206,10 +451,13 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingEvents");
 
   // When loading from a save state, we must assume the Event order is random and meaningless.
-  // The exact layout of the heap in memory is implementation defined, therefore it is platform
-  // and library version specific.
+  // Older states stored the layout of a heap, which is platform and library version specific.
   if (p.GetMode() == PointerWrap::MODE_READ)
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+  {
+    ClearPendingEvents();
+    for (const Event& ev : events)
+      s_event_queue.Push(ev);
+  }
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -232,7 +480,12 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-  s_event_queue.clear();
+  s_event_queue.Clear();
+  for (auto& event_type : s_event_types)
+  {
+    event_type.second.removed_before = 0;
+    event_type.second.pending = 0;
+  }
 }
 
 void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
@@ -260,8 +513,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
     if (!s_is_global_timer_sane)
       ForceExceptionCheck(cycles_into_future);
 
-    s_event_queue.emplace_back(Event{timeout, s_event_fifo_id++, userdata, event_type});
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue.Push(Event{timeout, s_event_fifo_id++, userdata, event_type});
   }
   else
   {
@@ -272,22 +524,22 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
                 event_type->name->c_str());
     }
 
-    std::lock_guard<std::mutex> lk(s_ts_write_lock);
-    s_ts_queue.Push(Event{g.global_timer + cycles_into_future, 0, userdata, event_type});
+    // Number the event before choosing between the queue and the overflow, so that MoveEvents
+    // can put the events of this thread back in order whichever path they take.
+    const Event ev{g.global_timer + cycles_into_future,
+                   s_ts_sequence.fetch_add(1, std::memory_order_relaxed), userdata, event_type};
+    if (s_ts_overflowed.load(std::memory_order_relaxed) || !s_ts_queue.Push(ev))
+    {
+      std::lock_guard<std::mutex> lk(s_ts_overflow_lock);
+      s_ts_overflow.push_back(ev);
+      s_ts_overflowed.store(true, std::memory_order_release);
+    }
   }
 }
 
 void RemoveEvent(EventType* event_type)
 {
-  auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; });
-
-  // Removing random items breaks the invariant so we have to re-establish it.
-  if (itr != s_event_queue.end())
-  {
-    s_event_queue.erase(itr, s_event_queue.end());
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+  s_event_queue.Cancel(event_type, s_event_fifo_id);
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -310,12 +562,34 @@ void ForceExceptionCheck(s64 cycles)
 
 void MoveEvents()
 {
+  // Check the overflow flag first: if it is set, every event that went into s_ts_queue before
+  // the overflow is visible to the loop below, so the events stay in order.
+  const bool overflowed = s_ts_overflowed.load(std::memory_order_acquire);
+
   for (Event ev; s_ts_queue.Pop(ev);)
+    s_ts_moved_events.push_back(ev);
+
+  if (overflowed)
+  {
+    std::lock_guard<std::mutex> lk(s_ts_overflow_lock);
+    s_ts_moved_events.insert(s_ts_moved_events.end(), s_ts_overflow.begin(), s_ts_overflow.end());
+    s_ts_overflow.clear();
+    s_ts_overflowed.store(false, std::memory_order_relaxed);
+  }
+
+  if (s_ts_moved_events.empty())
+    return;
+
+  // Events of one thread can have been split between the queue and the overflow, so sort them
+  // by the order they were scheduled in.
+  std::sort(s_ts_moved_events.begin(), s_ts_moved_events.end(),
+            [](const Event& a, const Event& b) { return a.fifo_order < b.fifo_order; });
+  for (Event& ev : s_ts_moved_events)
   {
     ev.fifo_order = s_event_fifo_id++;
-    s_event_queue.emplace_back(std::move(ev));
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue.Push(ev);
   }
+  s_ts_moved_events.clear();
 }
 
 void Advance()
@@ -330,11 +604,10 @@ void Advance()
 
   s_is_global_timer_sane = true;
 
-  while (!s_event_queue.empty() && s_event_queue.front().time <= g.global_timer)
+  for (const Event* front = s_event_queue.Front(); front && front->time <= g.global_timer;
+       front = s_event_queue.Front())
   {
-    Event evt = std::move(s_event_queue.front());
-    std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-    s_event_queue.pop_back();
+    Event evt = s_event_queue.PopFront();
     // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
     //            g.global_timer, evt.time);
     evt.type->callback(evt.userdata, g.global_timer - evt.time);
@@ -343,10 +616,10 @@ void Advance()
   s_is_global_timer_sane = false;
 
   // Still events left (scheduled in the future)
-  if (!s_event_queue.empty())
+  if (const Event* front = s_event_queue.Front())
   {
-    g.slice_length = static_cast<int>(
-        std::min<s64>(s_event_queue.front().time - g.global_timer, MAX_SLICE_LENGTH));
+    g.slice_length =
+        static_cast<int>(std::min<s64>(front->time - g.global_timer, MAX_SLICE_LENGTH));
   }
 
   PowerPC::ppcState.downcount = CyclesToDowncount(g.slice_length);
@@ -356,11 +629,17 @@ void Advance()
   // until the next slice:
   //        Pokemon Box refuses to boot if the first exception from the audio DMA is received late
   PowerPC::CheckExternalExceptions();
+
+  if (s_was_idle)
+  {
+    s_was_idle = false;
+    JitInterface::CompileProfiledBlocks();
+  }
 }
 
 void LogPendingEvents()
 {
-  auto clone = s_event_queue;
+  auto clone = s_event_queue.GetEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
@@ -372,11 +651,10 @@ void LogPendingEvents()
 // Should only be called from the CPU thread after the PPC clock has changed
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock)
 {
-  for (Event& ev : s_event_queue)
-  {
+  s_event_queue.ModifyEvents([&](Event& ev) {
     const s64 ticks = (ev.time - g.global_timer) * new_ppc_clock / old_ppc_clock;
     ev.time = g.global_timer + ticks;
-  }
+  });
 }
 
 void Idle()
@@ -391,6 +669,7 @@ void Idle()
 
   s_idled_cycles += DowncountToCycles(PowerPC::ppcState.downcount);
   PowerPC::ppcState.downcount = 0;
+  s_was_idle = true;
 }
 
 std::string GetScheduledEventsSummary()
@@ -398,7 +677,7 @@ std::string GetScheduledEventsSummary()
   std::string text = "Scheduled events\n";
   text.reserve(1000);
 
-  auto clone = s_event_queue;
+  auto clone = s_event_queue.GetEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
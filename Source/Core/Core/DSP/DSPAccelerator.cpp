@@ -4,6 +4,8 @@
 
 #include "Core/DSP/DSPAccelerator.h"
 
+#include <algorithm>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
@@ -60,6 +62,13 @@ void Accelerator::WriteD3(u16 value)
 
 u16 Accelerator::Read(s16* coefs)
 {
+  bool end_exception;
+  return ReadSample(coefs, &end_exception);
+}
+
+u16 Accelerator::ReadSample(s16* coefs, bool* end_exception)
+{
+  *end_exception = false;
   if (m_reads_stopped)
     return 0x0000;
 
@@ -153,6 +162,7 @@ u16 Accelerator::Read(s16* coefs)
     // Set address back to start address.
     m_current_address = m_start_address;
     m_reads_stopped = true;
+    *end_exception = true;
     OnEndException();
   }
 
@@ -160,6 +170,120 @@ u16 Accelerator::Read(s16* coefs)
   return val;
 }
 
+// Sign extended 4-bit ADPCM values.
+static constexpr s8 s_nibble_values[16] = {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1};
+
+u32 Accelerator::ReadSamples(s16* output, u32 count, s16* coefs)
+{
+  u32 i = 0;
+  while (i < count)
+  {
+    if (m_reads_stopped)
+    {
+      // Nothing but SetYn2 can resume reads.
+      std::fill(output + i, output + count, 0);
+      return count;
+    }
+
+    const u32 run = std::min(count - i, GetSimpleReadCount());
+    if (run == 0)
+    {
+      bool end_exception;
+      output[i++] = static_cast<s16>(ReadSample(coefs, &end_exception));
+      if (end_exception)
+        return i;
+      continue;
+    }
+
+    switch (m_sample_format)
+    {
+    case 0x00:  // ADPCM audio
+      ReadADPCMRun(output + i, run, coefs);
+      break;
+    case 0x0A:  // 16-bit PCM audio
+      for (u32 j = 0; j < run; ++j)
+      {
+        const u32 address = m_current_address + j;
+        output[i + j] =
+            static_cast<s16>((ReadMemory(address * 2) << 8) | ReadMemory(address * 2 + 1));
+      }
+      break;
+    case 0x19:  // 8-bit PCM audio
+      for (u32 j = 0; j < run; ++j)
+        output[i + j] = static_cast<s16>(ReadMemory(m_current_address + j) << 8);
+      break;
+    }
+
+    if (m_sample_format != 0x00)
+    {
+      m_yn2 = run > 1 ? output[i + run - 2] : m_yn1;
+      m_yn1 = output[i + run - 1];
+    }
+    m_current_address += run;
+    i += run;
+  }
+  return count;
+}
+
+// Returns how many samples can be read starting at the current address without anything
+// happening besides decoding and incrementing the address: no ADPCM frame header, no looping
+// and no end exception. Every such event happens when the incremented address is a multiple of
+// 16 or is within one of the end address.
+u32 Accelerator::GetSimpleReadCount() const
+{
+  if (m_sample_format != 0x00 && m_sample_format != 0x0A && m_sample_format != 0x19)
+    return 0;
+
+  // Incremented addresses up to (address | 15) - 1 are not multiples of 16. This also keeps
+  // the address below bit 30, which SetCurrentAddress masks out.
+  const s64 address = m_current_address;
+  s64 count = (address | 15) - address;
+
+  const s64 end = m_end_address;
+  if (address + 1 <= end + 1)
+    count = std::min(count, std::max<s64>(end - 1 - (address + 1), 0));
+  return static_cast<u32>(count);
+}
+
+void Accelerator::ReadADPCMRun(s16* output, u32 count, const s16* coefs)
+{
+  // The predictor and scale only change at frame headers, which runs never cross.
+  const int scale = 1 << (m_pred_scale & 0xF);
+  const int coef_idx = (m_pred_scale >> 4) & 0x7;
+  const s32 coef1 = coefs[coef_idx * 2 + 0];
+  const s32 coef2 = coefs[coef_idx * 2 + 1];
+
+  s32 scaled_nibbles[16];
+  for (int i = 0; i < 16; ++i)
+    scaled_nibbles[i] = scale * s_nibble_values[i];
+
+  s32 yn1 = m_yn1;
+  s32 yn2 = m_yn2;
+  const auto decode = [&](int nibble) {
+    const s32 val32 = scaled_nibbles[nibble] + ((0x400 + coef1 * yn1 + coef2 * yn2) >> 11);
+    yn2 = yn1;
+    yn1 = MathUtil::Clamp<s32>(val32, -0x7FFF, 0x7FFF);
+    return static_cast<s16>(yn1);
+  };
+
+  // Each byte holds two samples, high nibble first.
+  u32 address = m_current_address;
+  u32 i = 0;
+  if (address & 1)
+    output[i++] = decode(ReadMemory(address++ >> 1) & 0xF);
+  for (; i + 2 <= count; i += 2, address += 2)
+  {
+    const u8 byte = ReadMemory(address >> 1);
+    output[i] = decode(byte >> 4);
+    output[i + 1] = decode(byte & 0xF);
+  }
+  if (i < count)
+    output[i] = decode(ReadMemory(address >> 1) >> 4);
+
+  m_yn1 = static_cast<s16>(yn1);
+  m_yn2 = static_cast<s16>(yn2);
+}
+
 void Accelerator::DoState(PointerWrap& p)
 {
   p.Do(m_start_address);
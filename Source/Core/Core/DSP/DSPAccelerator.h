@@ -16,6 +16,11 @@ public:
   virtual ~Accelerator() = default;
 
   u16 Read(s16* coefs);
+  // Decodes up to count samples into output, with the same results as calling Read count times.
+  // Runs of samples which do not cross an ADPCM frame or get near the end address are decoded
+  // without going through the per-sample checks. Stops after a sample which raised an end
+  // exception, so that the caller can react to it. Returns the number of samples decoded.
+  u32 ReadSamples(s16* output, u32 count, s16* coefs);
   // Zelda ucode reads ARAM through 0xffd3.
   u16 ReadD3();
   void WriteD3(u16 value);
@@ -42,6 +47,10 @@ protected:
   virtual u8 ReadMemory(u32 address) = 0;
   virtual void WriteMemory(u32 address, u8 value) = 0;
 
+  u16 ReadSample(s16* coefs, bool* end_exception);
+  u32 GetSimpleReadCount() const;
+  void ReadADPCMRun(s16* output, u32 count, const s16* coefs);
+
   // DSP accelerator registers.
   u32 m_start_address = 0;
   u32 m_end_address = 0;
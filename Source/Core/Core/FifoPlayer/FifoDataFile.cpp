@@ -8,15 +8,21 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
+#include <zlib.h>
 
 #include "Common/File.h"
+#include "Common/Logging/Log.h"
+#include "Common/MappedFile.h"
 
 enum
 {
   FILE_ID = 0x0d01f1f0,
-  VERSION_NUMBER = 4,
+  VERSION_NUMBER = 5,
   MIN_LOADER_VERSION = 1,
+  // Memory update data can be compressed since version 5.
+  MIN_COMPRESSED_LOADER_VERSION = 5,
 };
 
 #pragma pack(push, 1)
@@ -66,8 +72,62 @@ struct FileMemoryUpdate
 };
 static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate should be 24 bytes");
 
+// Memory updates with identical contents point to the same data. In files with compressed
+// memory updates, the data is preceded by this header. If compressedSize is equal to the
+// dataSize of the update, the data is stored uncompressed.
+struct FileMemoryBlob
+{
+  u32 compressedSize;
+};
+
 #pragma pack(pop)
 
+template <typename T>
+static bool ReadArray(const File::MappedFile& file, u64 offset, T* data, size_t count)
+{
+  const u8* src = file.GetPointer(offset, count * sizeof(T));
+  if (!src)
+    return false;
+
+  std::memcpy(data, src, count * sizeof(T));
+  return true;
+}
+
+MemoryBlob::MemoryBlob(std::vector<u8> data)
+    : m_data(std::move(data)), m_storedData(m_data.data()),
+      m_storedSize(static_cast<u32>(m_data.size())), m_size(m_storedSize)
+{
+}
+
+MemoryBlob::MemoryBlob(std::shared_ptr<const File::MappedFile> file, u64 offset, u32 storedSize,
+                       u32 size)
+    : m_file(std::move(file)), m_offset(offset), m_storedData(m_file->GetData() + offset),
+      m_storedSize(storedSize), m_size(size)
+{
+}
+
+void MemoryBlob::CopyTo(u8* dest) const
+{
+  if (!IsCompressed())
+  {
+    std::memcpy(dest, m_storedData, m_size);
+    return;
+  }
+
+  uLongf size = m_size;
+  if (uncompress(dest, &size, m_storedData, m_storedSize) != Z_OK || size != m_size)
+  {
+    ERROR_LOG(COMMON, "FIFO log: failed to decompress %u bytes of memory update data", m_size);
+    std::memset(dest, 0, m_size);
+  }
+}
+
+void MemoryBlob::Release() const
+{
+  if (m_file)
+    m_file->Release(m_offset, m_storedSize);
+}
+
 FifoDataFile::FifoDataFile() = default;
 
 FifoDataFile::~FifoDataFile() = default;
@@ -92,7 +152,7 @@ void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
   m_Frames.push_back(frameInfo);
 }
 
-bool FifoDataFile::Save(const std::string& filename)
+bool FifoDataFile::Save(const std::string& filename, bool compress)
 {
   File::IOFile file;
   if (!file.Open(filename, "wb"))
@@ -124,7 +184,7 @@ bool FifoDataFile::Save(const std::string& filename)
   FileHeader header;
   header.fileId = FILE_ID;
   header.file_version = VERSION_NUMBER;
-  header.min_loader_version = MIN_LOADER_VERSION;
+  header.min_loader_version = compress ? MIN_COMPRESSED_LOADER_VERSION : MIN_LOADER_VERSION;
 
   header.bpMemOffset = bpMemOffset;
   header.bpMemSize = BP_MEM_SIZE;
@@ -144,12 +204,15 @@ bool FifoDataFile::Save(const std::string& filename)
   header.frameListOffset = frameListOffset;
   header.frameCount = (u32)m_Frames.size();
 
-  header.flags = m_Flags;
+  header.flags = m_Flags & ~FLAG_COMPRESSED_MEMORY_UPDATES;
+  if (compress)
+    header.flags |= FLAG_COMPRESSED_MEMORY_UPDATES;
 
   file.Seek(0, SEEK_SET);
   file.WriteBytes(&header, sizeof(FileHeader));
 
   // Write frames list
+  BlobOffsetMap blobOffsets;
   for (unsigned int i = 0; i < m_Frames.size(); ++i)
   {
     const FifoFrameInfo& srcFrame = m_Frames[i];
@@ -157,12 +220,13 @@ bool FifoDataFile::Save(const std::string& filename)
     // Write FIFO data
     file.Seek(0, SEEK_END);
     u64 dataOffset = file.Tell();
-    file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
+    file.WriteBytes(srcFrame.fifoData->GetData(), srcFrame.fifoData->GetSize());
 
-    u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
+    u64 memoryUpdatesOffset =
+        WriteMemoryUpdates(srcFrame.memoryUpdates, compress, blobOffsets, file);
 
     FileFrameInfo dstFrame;
-    dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
+    dstFrame.fifoDataSize = srcFrame.fifoData->GetSize();
     dstFrame.fifoDataOffset = dataOffset;
     dstFrame.fifoStart = srcFrame.fifoStart;
     dstFrame.fifoEnd = srcFrame.fifoEnd;
@@ -183,17 +247,14 @@ bool FifoDataFile::Save(const std::string& filename)
 
 std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bool flagsOnly)
 {
-  File::IOFile file;
-  file.Open(filename, "rb");
-  if (!file)
+  auto file = std::make_shared<File::MappedFile>();
+  if (!file->Open(filename))
     return nullptr;
 
   FileHeader header;
-  file.ReadBytes(&header, sizeof(header));
-
-  if (header.fileId != FILE_ID || header.min_loader_version > VERSION_NUMBER)
+  if (!ReadArray(*file, 0, &header, 1) || header.fileId != FILE_ID ||
+      header.min_loader_version > VERSION_NUMBER)
   {
-    file.Close();
     return nullptr;
   }
 
@@ -203,63 +264,68 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
   dataFile->m_Version = header.file_version;
 
   if (flagsOnly)
-  {
-    file.Close();
     return dataFile;
-  }
-
-  u32 size = std::min<u32>(BP_MEM_SIZE, header.bpMemSize);
-  file.Seek(header.bpMemOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_BPMem, size);
 
-  size = std::min<u32>(CP_MEM_SIZE, header.cpMemSize);
-  file.Seek(header.cpMemOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_CPMem, size);
-
-  size = std::min<u32>(XF_MEM_SIZE, header.xfMemSize);
-  file.Seek(header.xfMemOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_XFMem, size);
-
-  size = std::min<u32>(XF_REGS_SIZE, header.xfRegsSize);
-  file.Seek(header.xfRegsOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_XFRegs, size);
+  if (!ReadArray(*file, header.bpMemOffset, dataFile->m_BPMem,
+                 std::min<u32>(BP_MEM_SIZE, header.bpMemSize)) ||
+      !ReadArray(*file, header.cpMemOffset, dataFile->m_CPMem,
+                 std::min<u32>(CP_MEM_SIZE, header.cpMemSize)) ||
+      !ReadArray(*file, header.xfMemOffset, dataFile->m_XFMem,
+                 std::min<u32>(XF_MEM_SIZE, header.xfMemSize)) ||
+      !ReadArray(*file, header.xfRegsOffset, dataFile->m_XFRegs,
+                 std::min<u32>(XF_REGS_SIZE, header.xfRegsSize)))
+  {
+    return nullptr;
+  }
 
   // Texture memory saving was added in version 4.
   std::memset(dataFile->m_TexMem, 0, TEX_MEM_SIZE);
-  if (dataFile->m_Version >= 4)
+  if (dataFile->m_Version >= 4 &&
+      !ReadArray(*file, header.texMemOffset, dataFile->m_TexMem,
+                 std::min<u32>(TEX_MEM_SIZE, header.texMemSize)))
   {
-    size = std::min<u32>(TEX_MEM_SIZE, header.texMemSize);
-    file.Seek(header.texMemOffset, SEEK_SET);
-    file.ReadArray(dataFile->m_TexMem, size);
+    return nullptr;
   }
 
-  // Read frames
+  // Read frames. Their data stays in the mapped file.
+  const bool compressed = (header.flags & FLAG_COMPRESSED_MEMORY_UPDATES) != 0;
+  BlobMap blobs;
+  dataFile->m_Frames.resize(header.frameCount);
   for (u32 i = 0; i < header.frameCount; ++i)
   {
     u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-    file.Seek(frameOffset, SEEK_SET);
     FileFrameInfo srcFrame;
-    file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
-
-    FifoFrameInfo dstFrame;
-    dstFrame.fifoData.resize(srcFrame.fifoDataSize);
+    if (!ReadArray(*file, frameOffset, &srcFrame, 1) ||
+        !file->GetPointer(srcFrame.fifoDataOffset, srcFrame.fifoDataSize))
+    {
+      return nullptr;
+    }
+
+    FifoFrameInfo& dstFrame = dataFile->m_Frames[i];
+    dstFrame.fifoData = std::make_shared<const MemoryBlob>(file, srcFrame.fifoDataOffset,
+                                                           srcFrame.fifoDataSize,
+                                                           srcFrame.fifoDataSize);
     dstFrame.fifoStart = srcFrame.fifoStart;
     dstFrame.fifoEnd = srcFrame.fifoEnd;
 
-    file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-    file.ReadBytes(dstFrame.fifoData.data(), srcFrame.fifoDataSize);
-
-    ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
-                      dstFrame.memoryUpdates, file);
-
-    dataFile->AddFrame(dstFrame);
+    if (!ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates, compressed,
+                           dstFrame.memoryUpdates, blobs, file))
+    {
+      return nullptr;
+    }
   }
 
-  file.Close();
-
   return dataFile;
 }
 
+void FifoDataFile::ReleaseFrame(u32 frame) const
+{
+  const FifoFrameInfo& frameInfo = m_Frames[frame];
+  frameInfo.fifoData->Release();
+  for (const MemoryUpdate& update : frameInfo.memoryUpdates)
+    update.data->Release();
+}
+
 void FifoDataFile::PadFile(size_t numBytes, File::IOFile& file)
 {
   for (size_t i = 0; i < numBytes; ++i)
@@ -279,8 +345,8 @@ bool FifoDataFile::GetFlag(u32 flag) const
   return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-                                     File::IOFile& file)
+u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, bool compress,
+                                     BlobOffsetMap& blobOffsets, File::IOFile& file)
 {
   // Add space for memory update list
   u64 updateListOffset = file.Tell();
@@ -290,15 +356,20 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates
   {
     const MemoryUpdate& srcUpdate = memUpdates[i];
 
-    // Write memory
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
+    // Write memory, unless an earlier update had the same contents
+    auto blobOffset = blobOffsets.find(srcUpdate.data.get());
+    if (blobOffset == blobOffsets.end())
+    {
+      blobOffset = blobOffsets
+                       .emplace(srcUpdate.data.get(),
+                                WriteMemoryBlob(*srcUpdate.data, compress, file))
+                       .first;
+    }
 
     FileMemoryUpdate dstUpdate;
     dstUpdate.address = srcUpdate.address;
-    dstUpdate.dataOffset = dataOffset;
-    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
+    dstUpdate.dataOffset = blobOffset->second;
+    dstUpdate.dataSize = srcUpdate.data->GetSize();
     dstUpdate.fifoPosition = srcUpdate.fifoPosition;
     dstUpdate.type = srcUpdate.type;
 
@@ -310,25 +381,96 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates
   return updateListOffset;
 }
 
-void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-                                     std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
+u64 FifoDataFile::WriteMemoryBlob(const MemoryBlob& blob, bool compress, File::IOFile& file)
+{
+  file.Seek(0, SEEK_END);
+  u64 dataOffset = file.Tell();
+
+  FileMemoryBlob dstBlob;
+
+  // Blobs loaded from a compressed file are copied as they are.
+  if (compress && blob.IsCompressed())
+  {
+    dstBlob.compressedSize = blob.GetStoredSize();
+    file.WriteBytes(&dstBlob, sizeof(FileMemoryBlob));
+    file.WriteBytes(blob.GetStoredData(), blob.GetStoredSize());
+    return dataOffset;
+  }
+
+  std::vector<u8> decompressedData;
+  const u8* data = blob.GetData();
+  if (!data)
+  {
+    decompressedData.resize(blob.GetSize());
+    blob.CopyTo(decompressedData.data());
+    data = decompressedData.data();
+  }
+
+  if (!compress)
+  {
+    file.WriteBytes(data, blob.GetSize());
+    return dataOffset;
+  }
+
+  std::vector<u8> compressedData(compressBound(blob.GetSize()));
+  uLongf compressedSize = static_cast<uLongf>(compressedData.size());
+  if (compress2(compressedData.data(), &compressedSize, data, blob.GetSize(),
+                Z_DEFAULT_COMPRESSION) == Z_OK &&
+      compressedSize < blob.GetSize())
+  {
+    dstBlob.compressedSize = static_cast<u32>(compressedSize);
+    file.WriteBytes(&dstBlob, sizeof(FileMemoryBlob));
+    file.WriteBytes(compressedData.data(), compressedSize);
+  }
+  else
+  {
+    dstBlob.compressedSize = blob.GetSize();
+    file.WriteBytes(&dstBlob, sizeof(FileMemoryBlob));
+    file.WriteBytes(data, blob.GetSize());
+  }
+
+  return dataOffset;
+}
+
+bool FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, bool compressed,
+                                     std::vector<MemoryUpdate>& memUpdates, BlobMap& blobs,
+                                     const std::shared_ptr<const File::MappedFile>& file)
 {
   memUpdates.resize(numUpdates);
 
   for (u32 i = 0; i < numUpdates; ++i)
   {
     u64 updateOffset = fileOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, SEEK_SET);
     FileMemoryUpdate srcUpdate;
-    file.ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
+    if (!ReadArray(*file, updateOffset, &srcUpdate, 1))
+      return false;
 
     MemoryUpdate& dstUpdate = memUpdates[i];
     dstUpdate.address = srcUpdate.address;
     dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.data.resize(srcUpdate.dataSize);
     dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
 
-    file.Seek(srcUpdate.dataOffset, SEEK_SET);
-    file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
+    // Updates that share their data also share the blob in memory
+    std::shared_ptr<const MemoryBlob>& blob = blobs[srcUpdate.dataOffset];
+    if (!blob || blob->GetSize() != srcUpdate.dataSize)
+    {
+      u64 dataOffset = srcUpdate.dataOffset;
+      FileMemoryBlob srcBlob = {srcUpdate.dataSize};
+      if (compressed)
+      {
+        if (!ReadArray(*file, dataOffset, &srcBlob, 1))
+          return false;
+        dataOffset += sizeof(FileMemoryBlob);
+      }
+
+      if (!file->GetPointer(dataOffset, srcBlob.compressedSize))
+        return false;
+
+      blob = std::make_shared<const MemoryBlob>(file, dataOffset, srcBlob.compressedSize,
+                                                srcUpdate.dataSize);
+    }
+    dstUpdate.data = blob;
   }
+
+  return true;
 }
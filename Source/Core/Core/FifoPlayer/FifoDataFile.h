@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,8 +14,46 @@
 namespace File
 {
 class IOFile;
+class MappedFile;
 }
 
+// A block of data in a FIFO log: the FIFO data of a frame, or the contents of a memory update.
+// Games upload the same textures and vertex data over and over, so memory updates with
+// identical contents share one blob, which is stored once in the file.
+//
+// The blobs of a loaded file point into the memory-mapped file, so they are only read from
+// disk when they are used.
+class MemoryBlob
+{
+public:
+  explicit MemoryBlob(std::vector<u8> data);
+  // The data is compressed if storedSize differs from size.
+  MemoryBlob(std::shared_ptr<const File::MappedFile> file, u64 offset, u32 storedSize, u32 size);
+
+  MemoryBlob(const MemoryBlob&) = delete;
+  MemoryBlob& operator=(const MemoryBlob&) = delete;
+
+  u32 GetSize() const { return m_size; }
+  bool IsCompressed() const { return m_storedSize != m_size; }
+  // Returns nullptr for compressed blobs.
+  const u8* GetData() const { return IsCompressed() ? nullptr : m_storedData; }
+  const u8* GetStoredData() const { return m_storedData; }
+  u32 GetStoredSize() const { return m_storedSize; }
+
+  // Writes the decompressed contents to dest, which must have room for GetSize() bytes.
+  void CopyTo(u8* dest) const;
+  // Lets the OS drop the blob from memory until it is used again.
+  void Release() const;
+
+private:
+  std::vector<u8> m_data;
+  std::shared_ptr<const File::MappedFile> m_file;
+  u64 m_offset = 0;
+  const u8* m_storedData;
+  u32 m_storedSize;
+  u32 m_size;
+};
+
 struct MemoryUpdate
 {
   enum Type
@@ -27,13 +66,13 @@ struct MemoryUpdate
 
   u32 fifoPosition;
   u32 address;
-  std::vector<u8> data;
+  std::shared_ptr<const MemoryBlob> data;
   Type type;
 };
 
 struct FifoFrameInfo
 {
-  std::vector<u8> fifoData;
+  std::shared_ptr<const MemoryBlob> fifoData;
 
   u32 fifoStart;
   u32 fifoEnd;
@@ -69,24 +108,36 @@ public:
   void AddFrame(const FifoFrameInfo& frameInfo);
   const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
   u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
-  bool Save(const std::string& filename);
+  // Lets the OS drop the data of a frame that has been played back from memory.
+  void ReleaseFrame(u32 frame) const;
+  // Compressed files can only be loaded by version 5 and later.
+  bool Save(const std::string& filename, bool compress = false);
 
+  // The file is memory-mapped, and only the list of frames and their memory updates is read
+  // up front. It must not be modified while it is loaded.
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
 
 private:
   enum
   {
-    FLAG_IS_WII = 1
+    FLAG_IS_WII = 1,
+    FLAG_COMPRESSED_MEMORY_UPDATES = 2,
   };
 
+  using BlobOffsetMap = std::map<const MemoryBlob*, u64>;
+  using BlobMap = std::map<u64, std::shared_ptr<const MemoryBlob>>;
+
   void PadFile(size_t numBytes, File::IOFile& file);
 
   void SetFlag(u32 flag, bool set);
   bool GetFlag(u32 flag) const;
 
-  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
-  static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-                                std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, bool compress,
+                         BlobOffsetMap& blobOffsets, File::IOFile& file);
+  static u64 WriteMemoryBlob(const MemoryBlob& blob, bool compress, File::IOFile& file);
+  static bool ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, bool compressed,
+                                std::vector<MemoryUpdate>& memUpdates, BlobMap& blobs,
+                                const std::shared_ptr<const File::MappedFile>& file);
 
   u32 m_BPMem[BP_MEM_SIZE];
   u32 m_CPMem[CP_MEM_SIZE];
@@ -53,7 +53,8 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
     std::vector<CmdData> prevCmds;
 #endif
 
-    while (cmdStart < frame.fifoData.size())
+    const u8* const fifoData = frame.fifoData->GetData();
+    while (cmdStart < frame.fifoData->GetSize())
     {
       // Add memory updates that have occurred before this point in the frame
       while (nextMemUpdate < frame.memoryUpdates.size() &&
@@ -65,12 +66,12 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
 
       bool wasDrawing = s_DrawingObject;
 
-      u32 cmdSize = FifoAnalyzer::AnalyzeCommand(&frame.fifoData[cmdStart], DECODE_PLAYBACK);
+      u32 cmdSize = FifoAnalyzer::AnalyzeCommand(&fifoData[cmdStart], DECODE_PLAYBACK);
 
 #if LOG_FIFO_CMDS
       CmdData cmdData;
       cmdData.offset = cmdStart;
-      cmdData.ptr = &frame.fifoData[cmdStart];
+      cmdData.ptr = &fifoData[cmdStart];
       cmdData.size = cmdSize;
       prevCmds.push_back(cmdData);
 #endif
@@ -98,5 +99,8 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile* file,
 
     if (analyzed.objectEnds.size() < analyzed.objectStarts.size())
       analyzed.objectEnds.push_back(cmdStart);
+
+    // Don't keep the whole file in memory after it has been opened
+    frame.fifoData->Release();
   }
 }
@@ -24,6 +24,7 @@
 #include "Core/PowerPC/PowerPC.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/PipelineTimings.h"
 
 // We need to include TextureDecoder.h for the texMem array.
 // TODO: Move texMem somewhere else so this isn't an issue.
@@ -149,6 +150,8 @@ CPU::State FifoPlayer::AdvanceFrame()
     WriteAllMemoryUpdates();
 
   WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
+  m_File->ReleaseFrame(m_CurrentFrame);
+  PipelineTimings::EndFrame(m_CurrentFrame);
 
   ++m_CurrentFrame;
   return CPU::State::Running;
@@ -217,7 +220,7 @@ void FifoPlayer::WriteFrame(const FifoFrameInfo& frame, const AnalyzedFrameInfo&
   // Core timing information
   m_CyclesPerFrame = SystemTimers::GetTicksPerSecond() / VideoInterface::GetTargetRefreshRate();
   m_ElapsedCycles = 0;
-  m_FrameFifoSize = static_cast<u32>(frame.fifoData.size());
+  m_FrameFifoSize = frame.fifoData->GetSize();
 
   // Determine start and end objects
   u32 numObjects = (u32)(info.objectStarts.size());
@@ -266,7 +269,7 @@ void FifoPlayer::WriteFrame(const FifoFrameInfo& frame, const AnalyzedFrameInfo&
   }
 
   // Write data after the last object
-  WriteFramePart(position, static_cast<u32>(frame.fifoData.size()), memoryUpdate, frame, info);
+  WriteFramePart(position, frame.fifoData->GetSize(), memoryUpdate, frame, info);
 
   FlushWGP();
 
@@ -281,7 +284,7 @@ void FifoPlayer::WriteFrame(const FifoFrameInfo& frame, const AnalyzedFrameInfo&
 void FifoPlayer::WriteFramePart(u32 dataStart, u32 dataEnd, u32& nextMemUpdate,
                                 const FifoFrameInfo& frame, const AnalyzedFrameInfo& info)
 {
-  const u8* const data = frame.fifoData.data();
+  const u8* const data = frame.fifoData->GetData();
 
   while (nextMemUpdate < frame.memoryUpdates.size() && dataStart < dataEnd)
   {
@@ -333,7 +336,7 @@ void FifoPlayer::WriteMemory(const MemoryUpdate& memUpdate)
   else
     mem = &Memory::m_pRAM[memUpdate.address & Memory::RAM_MASK];
 
-  std::copy(memUpdate.data.begin(), memUpdate.data.end(), mem);
+  memUpdate.data->CopyTo(mem);
 }
 
 void FifoPlayer::WriteFifo(const u8* data, u32 start, u32 end)
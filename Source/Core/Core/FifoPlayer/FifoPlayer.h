@@ -89,6 +89,9 @@ public:
   // If enabled then all memory updates happen at once before the first frame
   // Default is disabled
   void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+  // Whether to start over from the beginning of the frame range after its last frame.
+  // Defaults to the LoopReplay setting.
+  void SetLoop(bool loop) { m_Loop = loop; }
   // Callbacks
   void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
   void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
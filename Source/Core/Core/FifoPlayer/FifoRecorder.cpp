@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <cstring>
 
+#include "Common/Hash.h"
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 #include "Core/ConfigManager.h"
@@ -44,6 +45,8 @@ void FifoRecorder::StartRecording(s32 numFrames, CallbackFunc finishedCb)
   std::fill(m_Ram.begin(), m_Ram.end(), 0);
   std::fill(m_ExRam.begin(), m_ExRam.end(), 0);
 
+  m_MemoryBlobs.clear();
+
   m_File->SetIsWii(SConfig::GetInstance().bWii);
 
   if (!m_IsRecording)
@@ -89,7 +92,7 @@ void FifoRecorder::WriteGPCommand(const u8* data, u32 size)
 
   if (m_FrameEnded && m_FifoData.size() > 0)
   {
-    m_CurrentFrame.fifoData = m_FifoData;
+    m_CurrentFrame.fifoData = std::make_shared<const MemoryBlob>(m_FifoData);
 
     {
       std::lock_guard<std::recursive_mutex> lk(m_mutex);
@@ -135,8 +138,7 @@ void FifoRecorder::UseMemory(u32 address, u32 size, MemoryUpdate::Type type, boo
     memUpdate.address = address;
     memUpdate.fifoPosition = (u32)(m_FifoData.size());
     memUpdate.type = type;
-    memUpdate.data.resize(size);
-    std::copy(newData, newData + size, memUpdate.data.begin());
+    memUpdate.data = GetMemoryBlob(newData, size);
 
     m_CurrentFrame.memoryUpdates.push_back(std::move(memUpdate));
   }
@@ -147,6 +149,23 @@ void FifoRecorder::UseMemory(u32 address, u32 size, MemoryUpdate::Type type, boo
   }
 }
 
+std::shared_ptr<const MemoryBlob> FifoRecorder::GetMemoryBlob(const u8* data, u32 size)
+{
+  const u64 hash = GetHash64(data, size, 0);
+
+  const auto range = m_MemoryBlobs.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    const MemoryBlob& blob = *it->second;
+    if (blob.GetSize() == size && !std::memcmp(blob.GetData(), data, size))
+      return it->second;
+  }
+
+  auto blob = std::make_shared<const MemoryBlob>(std::vector<u8>(data, data + size));
+  m_MemoryBlobs.emplace(hash, blob);
+  return blob;
+}
+
 void FifoRecorder::EndFrame(u32 fifoStart, u32 fifoEnd)
 {
   // m_IsRecording is assumed to be true at this point, otherwise this function would not be called
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "Core/FifoPlayer/FifoDataFile.h"
@@ -45,6 +46,9 @@ public:
   static FifoRecorder& GetInstance();
 
 private:
+  // Returns a blob with the given contents, reusing one recorded earlier if possible.
+  std::shared_ptr<const MemoryBlob> GetMemoryBlob(const u8* data, u32 size);
+
   // Accessed from both GUI and video threads
 
   std::recursive_mutex m_mutex;
@@ -66,4 +70,6 @@ private:
   std::vector<u8> m_FifoData;
   std::vector<u8> m_Ram;
   std::vector<u8> m_ExRam;
+  // The contents of all memory updates in the recording, by hash.
+  std::unordered_multimap<u64, std::shared_ptr<const MemoryBlob>> m_MemoryBlobs;
 };
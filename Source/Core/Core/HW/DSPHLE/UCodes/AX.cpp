@@ -11,6 +11,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/Swap.h"
+#include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/DSPHLE.h"
 #include "Core/HW/DSPHLE/MailHandler.h"
@@ -44,6 +45,10 @@ void AXUCode::LoadResamplingCoefficients()
 {
   m_coeffs_available = false;
 
+  // Without the coefficients, voices that ask for polyphase resampling use linear interpolation.
+  if (!SConfig::GetInstance().m_DSPPolyphaseResampling)
+    return;
+
   std::string filenames[] = {File::GetUserPath(D_GCUSER_IDX) + "dsp_coef.bin",
                              File::GetSysDirectory() + "/GC/dsp_coef.bin"};
 
@@ -0,0 +1,282 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+
+#if defined(_M_X86) || defined(_M_X86_64)
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
+#elif defined(_M_ARM_64)
+#include <arm_neon.h>
+#endif
+
+namespace DSP
+{
+namespace HLE
+{
+namespace AXMix
+{
+// The vectorized kernels below process as many whole vectors as fit in count and return the
+// number of samples they handled. The product of an s16 sample and a u16 volume always fits in
+// 32 bits, so 32-bit lanes give exactly the same results as the scalar code.
+
+static s16 ScaleSample(s16 sample, u16 volume)
+{
+  return static_cast<s16>(MathUtil::Clamp((s32(sample) * volume) >> 15, -32767, 32767));
+}
+
+#if defined(_M_X86) || defined(_M_X86_64)
+FUNCTION_TARGET_SSR41
+static __m128i ScaleSamples_SSE41(__m128i samples, __m128i volumes)
+{
+  const __m128i scaled = _mm_srai_epi32(_mm_mullo_epi32(samples, volumes), 15);
+  return _mm_min_epi32(_mm_max_epi32(scaled, _mm_set1_epi32(-32767)), _mm_set1_epi32(32767));
+}
+
+FUNCTION_TARGET_SSR41
+static __m128i InitialVolumes_SSE41(u16 volume, u16 volume_delta)
+{
+  const __m128i steps = _mm_mullo_epi32(_mm_set1_epi32(volume_delta), _mm_setr_epi32(0, 1, 2, 3));
+  return _mm_and_si128(_mm_add_epi32(_mm_set1_epi32(volume), steps), _mm_set1_epi32(0xFFFF));
+}
+
+FUNCTION_TARGET_SSR41
+static u32 ApplyVolume_SSE41(s16* samples, u32 count, u16 volume, u16 volume_delta)
+{
+  __m128i volumes = InitialVolumes_SSE41(volume, volume_delta);
+  const __m128i step = _mm_set1_epi32(4 * volume_delta);
+  const __m128i mask = _mm_set1_epi32(0xFFFF);
+
+  u32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128i in =
+        _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i)));
+    const __m128i scaled = ScaleSamples_SSE41(in, volumes);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(samples + i), _mm_packs_epi32(scaled, scaled));
+    volumes = _mm_and_si128(_mm_add_epi32(volumes, step), mask);
+  }
+  return i;
+}
+
+FUNCTION_TARGET_SSR41
+static u32 MixAdd_SSE41(int* out, const s16* input, u32 count, u16 volume, u16 volume_delta)
+{
+  __m128i volumes = InitialVolumes_SSE41(volume, volume_delta);
+  const __m128i step = _mm_set1_epi32(4 * volume_delta);
+  const __m128i mask = _mm_set1_epi32(0xFFFF);
+
+  u32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128i in =
+        _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i)));
+    __m128i* const dest = reinterpret_cast<__m128i*>(out + i);
+    _mm_storeu_si128(dest,
+                     _mm_add_epi32(_mm_loadu_si128(dest), ScaleSamples_SSE41(in, volumes)));
+    volumes = _mm_and_si128(_mm_add_epi32(volumes, step), mask);
+  }
+  return i;
+}
+
+FUNCTION_TARGET_AVX2
+static __m256i ScaleSamples_AVX2(__m256i samples, __m256i volumes)
+{
+  const __m256i scaled = _mm256_srai_epi32(_mm256_mullo_epi32(samples, volumes), 15);
+  return _mm256_min_epi32(_mm256_max_epi32(scaled, _mm256_set1_epi32(-32767)),
+                          _mm256_set1_epi32(32767));
+}
+
+FUNCTION_TARGET_AVX2
+static __m256i InitialVolumes_AVX2(u16 volume, u16 volume_delta)
+{
+  const __m256i steps = _mm256_mullo_epi32(_mm256_set1_epi32(volume_delta),
+                                           _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  return _mm256_and_si256(_mm256_add_epi32(_mm256_set1_epi32(volume), steps),
+                          _mm256_set1_epi32(0xFFFF));
+}
+
+FUNCTION_TARGET_AVX2
+static u32 ApplyVolume_AVX2(s16* samples, u32 count, u16 volume, u16 volume_delta)
+{
+  __m256i volumes = InitialVolumes_AVX2(volume, volume_delta);
+  const __m256i step = _mm256_set1_epi32(8 * volume_delta);
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+
+  u32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256i in =
+        _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)));
+    const __m256i scaled = ScaleSamples_AVX2(in, volumes);
+    // Packing works within 128-bit lanes, so put the low halves of both lanes together.
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(scaled, scaled), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), _mm256_castsi256_si128(packed));
+    volumes = _mm256_and_si256(_mm256_add_epi32(volumes, step), mask);
+  }
+  return i;
+}
+
+FUNCTION_TARGET_AVX2
+static u32 MixAdd_AVX2(int* out, const s16* input, u32 count, u16 volume, u16 volume_delta)
+{
+  __m256i volumes = InitialVolumes_AVX2(volume, volume_delta);
+  const __m256i step = _mm256_set1_epi32(8 * volume_delta);
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+
+  u32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256i in =
+        _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+    __m256i* const dest = reinterpret_cast<__m256i*>(out + i);
+    _mm256_storeu_si256(
+        dest, _mm256_add_epi32(_mm256_loadu_si256(dest), ScaleSamples_AVX2(in, volumes)));
+    volumes = _mm256_and_si256(_mm256_add_epi32(volumes, step), mask);
+  }
+  return i;
+}
+#elif defined(_M_ARM_64)
+static int32x4_t ScaleSamples_NEON(int16x4_t samples, uint32x4_t volumes)
+{
+  const int32x4_t scaled =
+      vshrq_n_s32(vmulq_s32(vmovl_s16(samples), vreinterpretq_s32_u32(volumes)), 15);
+  return vminq_s32(vmaxq_s32(scaled, vdupq_n_s32(-32767)), vdupq_n_s32(32767));
+}
+
+static uint32x4_t InitialVolumes_NEON(u16 volume, u16 volume_delta)
+{
+  static const u32 lanes[4] = {0, 1, 2, 3};
+  const uint32x4_t steps = vmulq_n_u32(vld1q_u32(lanes), volume_delta);
+  return vandq_u32(vaddq_u32(vdupq_n_u32(volume), steps), vdupq_n_u32(0xFFFF));
+}
+
+static u32 ApplyVolume_NEON(s16* samples, u32 count, u16 volume, u16 volume_delta)
+{
+  uint32x4_t volumes = InitialVolumes_NEON(volume, volume_delta);
+  const uint32x4_t step = vdupq_n_u32(4 * volume_delta);
+  const uint32x4_t mask = vdupq_n_u32(0xFFFF);
+
+  u32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    vst1_s16(samples + i, vqmovn_s32(ScaleSamples_NEON(vld1_s16(samples + i), volumes)));
+    volumes = vandq_u32(vaddq_u32(volumes, step), mask);
+  }
+  return i;
+}
+
+static u32 MixAdd_NEON(int* out, const s16* input, u32 count, u16 volume, u16 volume_delta)
+{
+  uint32x4_t volumes = InitialVolumes_NEON(volume, volume_delta);
+  const uint32x4_t step = vdupq_n_u32(4 * volume_delta);
+  const uint32x4_t mask = vdupq_n_u32(0xFFFF);
+
+  u32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    vst1q_s32(out + i,
+              vaddq_s32(vld1q_s32(out + i), ScaleSamples_NEON(vld1_s16(input + i), volumes)));
+    volumes = vandq_u32(vaddq_u32(volumes, step), mask);
+  }
+  return i;
+}
+#endif
+
+Kernel GetDefaultKernel()
+{
+#if defined(_M_X86) || defined(_M_X86_64)
+  if (cpu_info.bAVX2)
+    return Kernel::AVX2;
+  if (cpu_info.bSSE4_1)
+    return Kernel::SSE41;
+#elif defined(_M_ARM_64)
+  return Kernel::NEON;
+#endif
+  return Kernel::Scalar;
+}
+
+void ApplyVolume(s16* samples, u32 count, u16* volume, u16 volume_delta)
+{
+  ApplyVolume(GetDefaultKernel(), samples, count, volume, volume_delta);
+}
+
+void MixAdd(int* out, const s16* input, u32 count, u16* volume, u16 volume_delta, s16* dpop)
+{
+  MixAdd(GetDefaultKernel(), out, input, count, volume, volume_delta, dpop);
+}
+
+void ApplyVolume(Kernel kernel, s16* samples, u32 count, u16* volume, u16 volume_delta)
+{
+  // The vector kernels return how many samples they processed; the rest is done here.
+  u32 i = 0;
+  switch (kernel)
+  {
+#if defined(_M_X86) || defined(_M_X86_64)
+  case Kernel::AVX2:
+    i = ApplyVolume_AVX2(samples, count, *volume, volume_delta);
+    break;
+  case Kernel::SSE41:
+    i = ApplyVolume_SSE41(samples, count, *volume, volume_delta);
+    break;
+#elif defined(_M_ARM_64)
+  case Kernel::NEON:
+    i = ApplyVolume_NEON(samples, count, *volume, volume_delta);
+    break;
+#endif
+  default:
+    break;
+  }
+
+  u16 current = static_cast<u16>(*volume + i * volume_delta);
+  for (; i < count; ++i)
+  {
+    samples[i] = ScaleSample(samples[i], current);
+    current += volume_delta;
+  }
+  *volume = current;
+}
+
+void MixAdd(Kernel kernel, int* out, const s16* input, u32 count, u16* volume, u16 volume_delta,
+            s16* dpop)
+{
+  if (count == 0)
+    return;
+
+  u32 i = 0;
+  switch (kernel)
+  {
+#if defined(_M_X86) || defined(_M_X86_64)
+  case Kernel::AVX2:
+    i = MixAdd_AVX2(out, input, count, *volume, volume_delta);
+    break;
+  case Kernel::SSE41:
+    i = MixAdd_SSE41(out, input, count, *volume, volume_delta);
+    break;
+#elif defined(_M_ARM_64)
+  case Kernel::NEON:
+    i = MixAdd_NEON(out, input, count, *volume, volume_delta);
+    break;
+#endif
+  default:
+    break;
+  }
+
+  u16 current = static_cast<u16>(*volume + i * volume_delta);
+  for (; i < count; ++i)
+  {
+    out[i] += ScaleSample(input[i], current);
+    current += volume_delta;
+  }
+  *volume = current;
+
+  // Like the ucode, remember the last mixed sample in the depop field.
+  *dpop = ScaleSample(input[count - 1], static_cast<u16>(current - volume_delta));
+}
+}  // namespace AXMix
+}  // namespace HLE
+}  // namespace DSP
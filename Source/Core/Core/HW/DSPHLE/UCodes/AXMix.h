@@ -0,0 +1,46 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace DSP
+{
+namespace HLE
+{
+namespace AXMix
+{
+// Per-buffer kernels shared by AX GC and AX Wii voice processing. They scale every sample by
+// a volume which is incremented by volume_delta (wrapping around) after each sample, then
+// compute (sample * volume) >> 15 clamped to [-32767, 32767], like the ucode does. *volume is
+// updated to the volume after the last sample. Vectorized versions are used when the CPU
+// supports them; they give the same results as the scalar code.
+
+// Scales samples in place.
+void ApplyVolume(s16* samples, u32 count, u16* volume, u16 volume_delta);
+
+// Adds the scaled samples to out. The last scaled sample is stored in *dpop, unless count is 0.
+void MixAdd(int* out, const s16* input, u32 count, u16* volume, u16 volume_delta, s16* dpop);
+
+enum class Kernel
+{
+  Scalar,
+  SSE41,
+  AVX2,
+  NEON,
+};
+
+// The kernel that the functions above use on this CPU.
+Kernel GetDefaultKernel();
+
+// The same, but with the given kernel, so that each one can be tested against the scalar code.
+// The CPU must support the kernel. Kernels that aren't built for this architecture fall back to
+// the scalar code.
+void ApplyVolume(Kernel kernel, s16* samples, u32 count, u16* volume, u16 volume_delta);
+void MixAdd(Kernel kernel, int* out, const s16* input, u32 count, u16* volume, u16 volume_delta,
+            s16* dpop);
+}  // namespace AXMix
+}  // namespace HLE
+}  // namespace DSP
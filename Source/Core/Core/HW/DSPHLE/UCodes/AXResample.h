@@ -0,0 +1,164 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Core/HW/DSPHLE/UCodes/AXStructs.h"
+
+namespace DSP
+{
+namespace HLE
+{
+namespace AXResample
+{
+// Maximum number of input samples decoded at once by ResampleAudio.
+constexpr u32 BLOCK_SIZE = 256;
+
+// Resamples count output samples from a contiguous input buffer. input[0..3] are the last four
+// samples of the previous block, followed by the new input samples. pos is the 16.16 position in
+// the input before the first output sample. Each output sample first advances pos by ratio and
+// is then computed from input[pos >> 16] and the following samples, like the ucode which keeps
+// the last four samples in a circular buffer. Returns the position after the last output sample.
+template <int SrcType>
+u32 ResampleBlock(const s16* input, s16* output, u32 count, u32 pos, u32 ratio,
+                  const s16* coeffs);
+
+// Linear interpolation between the two oldest samples of the history.
+template <>
+inline u32 ResampleBlock<SRCTYPE_LINEAR>(const s16* input, s16* output, u32 count, u32 pos,
+                                         u32 ratio, const s16*)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    pos += ratio;
+    const s16* samples = input + (pos >> 16);
+    const s32 frac = pos & 0xFFFF;
+
+    // A fractional position of 0 gives back samples[0] exactly, so there is no need to
+    // special case it.
+    output[i] = static_cast<s16>((samples[0] * (0x10000 - frac) + samples[1] * frac) >> 16);
+  }
+  return pos;
+}
+
+// 4-tap polyphase filter using the coefficients from the DSP DROM: 128 phases of 4 taps each.
+template <>
+inline u32 ResampleBlock<SRCTYPE_POLYPHASE>(const s16* input, s16* output, u32 count, u32 pos,
+                                            u32 ratio, const s16* coeffs)
+{
+  for (u32 i = 0; i < count; ++i)
+  {
+    pos += ratio;
+    const s16* samples = input + (pos >> 16);
+    const s16* c = &coeffs[((pos & 0xFFFF) >> 9) << 2];
+
+    const s64 sample = (static_cast<s64>(samples[0]) * c[0] + samples[1] * c[1] +
+                        samples[2] * c[2] + samples[3] * c[3]) >>
+                       15;
+
+    // The filter can overshoot on full scale input. Truncating to 16 bits turned these into
+    // full scale clicks of the opposite sign, so saturate instead.
+    output[i] = static_cast<s16>(MathUtil::Clamp<s64>(sample, -32768, 32767));
+  }
+  return pos;
+}
+
+// Reads input samples through read_input and resamples them to count samples at the rate
+// given by ratio.
+//
+// read_input(s16* buffer, u32 count) must write the next count input samples to buffer. It is
+// called once per block of at most BLOCK_SIZE samples rather than once per sample.
+//
+// If srctype is SRCTYPE_POLYPHASE, coefficients need to be provided as well (or the srctype
+// will automatically be changed to LINEAR).
+//
+// The input to output ratio is set in <ratio>, which is a floating point num stored as a 32b
+// integer:
+//  * Upper 16 bits of the ratio are the integer part
+//  * Lower 16 bits are the decimal part
+//
+// <curr_pos> is the fractional part of the current position in the input stream, in the lower
+// 16 bits. We start getting samples not from sample 0, but 0.<curr_pos>. This avoids
+// discontinuities in the audio stream, especially with very low ratios which interpolate a lot
+// of values between two "real" samples.
+//
+// <last_samples> holds the last four input samples, and is updated for the next call.
+//
+// Returns the fractional part of the position after resampling.
+template <typename ReadInput>
+u32 ResampleAudio(ReadInput read_input, s16* output, u32 count, s16* last_samples, u32 curr_pos,
+                  u32 ratio, int srctype, const s16* coeffs)
+{
+  if (srctype != SRCTYPE_LINEAR && srctype != SRCTYPE_POLYPHASE)
+  {
+    // No sample rate conversion here: simply read samples from the accelerator to the output
+    // buffer.
+    read_input(output, count);
+    std::memcpy(last_samples, output + count - 4, 4 * sizeof(s16));
+    return curr_pos;
+  }
+
+  const bool polyphase = coeffs && srctype == SRCTYPE_POLYPHASE;
+
+  s16 input[4 + BLOCK_SIZE];
+  std::memcpy(input, last_samples, 4 * sizeof(s16));
+
+  curr_pos &= 0xFFFF;
+  u32 i = 0;
+  while (i < count)
+  {
+    // Compute as many output samples as possible with at most BLOCK_SIZE new input samples.
+    const u64 max_pos = (static_cast<u64>(BLOCK_SIZE + 1) << 16) - 1;
+    u32 block_count = count - i;
+    u32 block_ratio = ratio;
+    if (ratio)
+      block_count = static_cast<u32>(std::min<u64>(block_count, (max_pos - curr_pos) / ratio));
+
+    if (block_count == 0)
+    {
+      // A single output sample skips more than a block of input. Decode the samples which do
+      // not contribute to it, then compute it from its position in the last block.
+      u64 target = static_cast<u64>(curr_pos) + ratio;
+      while ((target >> 16) > BLOCK_SIZE)
+      {
+        read_input(&input[4], BLOCK_SIZE);
+        std::memcpy(input, &input[BLOCK_SIZE], 4 * sizeof(s16));
+        target -= static_cast<u64>(BLOCK_SIZE) << 16;
+      }
+      curr_pos = static_cast<u32>(target);
+      block_ratio = 0;
+      block_count = 1;
+    }
+
+    const u32 input_count =
+        static_cast<u32>((curr_pos + static_cast<u64>(block_ratio) * block_count) >> 16);
+    read_input(&input[4], input_count);
+
+    if (polyphase)
+    {
+      curr_pos = ResampleBlock<SRCTYPE_POLYPHASE>(input, output + i, block_count, curr_pos,
+                                                  block_ratio, coeffs);
+    }
+    else
+    {
+      curr_pos = ResampleBlock<SRCTYPE_LINEAR>(input, output + i, block_count, curr_pos,
+                                               block_ratio, coeffs);
+    }
+
+    std::memmove(input, &input[input_count], 4 * sizeof(s16));
+    curr_pos &= 0xFFFF;
+    i += block_count;
+  }
+
+  std::memcpy(last_samples, input, 4 * sizeof(s16));
+  return curr_pos;
+}
+}  // namespace AXResample
+}  // namespace HLE
+}  // namespace DSP
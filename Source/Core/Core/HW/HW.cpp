@@ -77,9 +77,9 @@ void Shutdown()
   CoreTiming::Shutdown();
 }
 
-void DoState(PointerWrap& p)
+void DoState(PointerWrap& p, bool include_ram)
 {
-  Memory::DoState(p);
+  Memory::DoState(p, include_ram);
   p.DoMarker("Memory");
   VideoInterface::DoState(p);
   p.DoMarker("VideoInterface");
@@ -265,16 +265,17 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
   }
 }
 
-void DoState(PointerWrap& p)
+void DoState(PointerWrap& p, bool include_ram)
 {
   bool wii = SConfig::GetInstance().bWii;
-  p.DoArray(m_pRAM, RAM_SIZE);
+  if (include_ram)
+    p.DoArray(m_pRAM, RAM_SIZE);
   p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
   p.DoMarker("Memory RAM");
   if (m_pFakeVMEM)
     p.DoArray(m_pFakeVMEM, FAKEVMEM_SIZE);
   p.DoMarker("Memory FakeVMEM");
-  if (wii)
+  if (wii && include_ram)
     p.DoArray(m_pEXRAM, EXRAM_SIZE);
   p.DoMarker("Memory EXRAM");
 }
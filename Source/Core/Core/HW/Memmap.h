@@ -62,7 +62,9 @@ extern std::unique_ptr<MMIO::Mapping> mmio_mapping;
 bool IsInitialized();
 void Init();
 void Shutdown();
-void DoState(PointerWrap& p);
+// RAM and EXRAM are left out if include_ram is false, for the rewind snapshots that keep track
+// of them separately.
+void DoState(PointerWrap& p, bool include_ram = true);
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
 
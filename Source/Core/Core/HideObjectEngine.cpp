@@ -5,10 +5,13 @@
 // HideObjectEngine
 // Supports the removal of objects/effects from the rendering loop
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
 #include "Common/StringUtil.h"
 #include "Core/HideObjectEngine.h"
 #include "Core/ConfigManager.h"
-#include "Core/Core.h"
 
 namespace HideObjectEngine
 {
@@ -17,6 +20,74 @@ std::vector<std::string> HideObjectTypeStrings = {
     "72bits", "80bits", "88bits", "96bits", "104bits", "112bits", "120bits", "128bits"};
 
 static std::vector<HideObject> HideObjectCodes;
+// Only accessed through std::atomic_load/std::atomic_store.
+static std::shared_ptr<const Matcher> s_active_matcher;
+
+u64 Matcher::PackKey(const u8* data, size_t size)
+{
+  u64 key = 0;
+  std::memcpy(&key, data, std::min<size_t>(size, sizeof(key)));
+  return key;
+}
+
+void Matcher::Add(const std::vector<u8>& entry)
+{
+  if (entry.empty() || entry.size() > MAX_ENTRY_SIZE)
+    return;
+
+  const size_t length = entry.size();
+  const u64 head = PackKey(entry.data(), length);
+  const u64 tail = length > 8 ? PackKey(entry.data() + 8, length - 8) : 0;
+
+  std::vector<u64>& tails = m_buckets[length - 1][head];
+  if (std::find(tails.begin(), tails.end(), tail) != tails.end())
+    return;
+  tails.push_back(tail);
+
+  if (std::find(m_lengths.begin(), m_lengths.end(), length) == m_lengths.end())
+  {
+    m_lengths.push_back(length);
+    std::sort(m_lengths.begin(), m_lengths.end());
+  }
+  m_first_bytes.set(entry[0]);
+  ++m_entry_count;
+}
+
+void Matcher::Clear()
+{
+  for (LengthBucket& bucket : m_buckets)
+    bucket.clear();
+  m_lengths.clear();
+  m_first_bytes.reset();
+  m_entry_count = 0;
+}
+
+bool Matcher::Matches(const u8* data, size_t size, int* probes) const
+{
+  if (size == 0 || !m_first_bytes.test(data[0]))
+    return false;
+
+  for (size_t length : m_lengths)
+  {
+    if (length > size)
+      break;
+
+    ++*probes;
+    const LengthBucket& bucket = m_buckets[length - 1];
+    const auto it = bucket.find(PackKey(data, length));
+    if (it == bucket.end())
+      continue;
+
+    if (length <= 8)
+      return true;
+
+    const u64 tail = PackKey(data + 8, length - 8);
+    if (std::find(it->second.begin(), it->second.end(), tail) != it->second.end())
+      return true;
+  }
+
+  return false;
+}
 
 void LoadHideObjectSection(const std::string& section, std::vector<HideObject>& HideObjectects,
                            IniFile& globalIni, IniFile& localIni)
@@ -112,16 +183,7 @@ void LoadHideObjects()
 
 void ApplyHideObjects(const std::vector<HideObject>& HideObjectects)
 {
-  // Make the rendering code skip over checking skip entries
-  SConfig::GetInstance().hide_objects_updating = true;
-
-  // Wait until the next time the next time the rendering thread finishes checking the skip entries.
-  if (Core::IsRunning())
-    while (SConfig::GetInstance().hide_objects_done == false)
-    {
-    }
-
-  SConfig::GetInstance().object_removal_codes.clear();
+  auto matcher = std::make_shared<Matcher>();
 
   for (const HideObject& HideObjectect : HideObjectects)
   {
@@ -149,11 +211,13 @@ void ApplyHideObjects(const std::vector<HideObject>& HideObjectects)
           skipEntry.push_back((0xFF & (value_add_lower >> ((j - 1) * 8))));
         }
 
-        SConfig::GetInstance().object_removal_codes.push_back(skipEntry);
+        matcher->Add(skipEntry);
       }
     }
   }
-  SConfig::GetInstance().hide_objects_updating = false;
+
+  // The rendering code picks the new set up at its next frame boundary.
+  std::atomic_store(&s_active_matcher, std::shared_ptr<const Matcher>(std::move(matcher)));
 }
 
 void ApplyFrameHideObjects()
@@ -161,9 +225,15 @@ void ApplyFrameHideObjects()
   ApplyHideObjects(HideObjectCodes);
 }
 
+std::shared_ptr<const Matcher> GetActiveMatcher()
+{
+  return std::atomic_load(&s_active_matcher);
+}
+
 void Shutdown()
 {
   HideObjectCodes.clear();
+  std::atomic_store(&s_active_matcher, std::shared_ptr<const Matcher>());
 }
 
 }  // namespace
@@ -4,6 +4,16 @@
 
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
 class IniFile;
 
 namespace HideObjectEngine
@@ -50,11 +60,45 @@ struct HideObject
   bool user_defined;  // False if this code is shipped with Dolphin.
 };
 
+// Compiled form of the active hide object codes, queried by the vertex loader for every draw.
+// Entries are grouped by their length in bytes and hashed on their leading (up to 8) bytes, so a
+// lookup costs at most one hash probe per distinct entry length, regardless of how many codes
+// are active.
+class Matcher
+{
+public:
+  static constexpr size_t MAX_ENTRY_SIZE = 16;
+
+  void Add(const std::vector<u8>& entry);
+  void Clear();
+
+  bool IsEmpty() const { return m_entry_count == 0; }
+  size_t GetEntryCount() const { return m_entry_count; }
+  // Returns true if data starts with any of the added entries. The number of hash probes that
+  // were needed is added to *probes.
+  bool Matches(const u8* data, size_t size, int* probes) const;
+
+private:
+  static u64 PackKey(const u8* data, size_t size);
+
+  // Keyed on the first min(length, 8) bytes; the values are the remaining bytes of the entries
+  // longer than 8 bytes (zero for shorter entries).
+  using LengthBucket = std::unordered_map<u64, std::vector<u64>>;
+
+  std::array<LengthBucket, MAX_ENTRY_SIZE> m_buckets;  // indexed by entry length - 1
+  std::vector<size_t> m_lengths;                        // lengths in use, in ascending order
+  std::bitset<256> m_first_bytes;
+  size_t m_entry_count = 0;
+};
+
 void LoadHideObjectSection(const std::string& section, std::vector<HideObject>& patches,
                            IniFile& globalIni, IniFile& localIni);
 void LoadHideObjects();
 void ApplyHideObjects(const std::vector<HideObject>& HideObjectects);
 void ApplyFrameHideObjects();
+// Returns the most recently applied set of codes. Snapshots are immutable once published, so the
+// GPU thread can keep using one while the UI applies a new one.
+std::shared_ptr<const Matcher> GetActiveMatcher();
 void Shutdown();
 
 inline int GetHideObjectTypeCharLength(HideObjectType type)
@@ -11,6 +11,7 @@
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 
@@ -50,6 +51,8 @@ LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
     }
     else
     {
+      // The process is about to go down, so write out what has been logged.
+      FlushLogs();
       // Let's not prevent debugging.
       return (DWORD)EXCEPTION_CONTINUE_SEARCH;
     }
@@ -263,6 +266,8 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
 #endif
                                  ))
   {
+    // The process is about to go down, so write out what has been logged.
+    FlushLogs();
     // retry and crash
     signal(SIGSEGV, SIG_DFL);
 #ifdef __APPLE__
@@ -25,6 +25,7 @@
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
+#include "Common/MappedFile.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
 #include "Common/Timer.h"
@@ -48,6 +49,7 @@
 #include "Core/HW/WiimoteEmu/WiimoteEmu.h"
 #include "Core/IOS/USB/Bluetooth/BTEmu.h"
 #include "Core/IOS/USB/Bluetooth/WiimoteDevice.h"
+#include "Core/MovieInput.h"
 #include "Core/NetPlayProto.h"
 #include "Core/State.h"
 
@@ -59,9 +61,6 @@
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoConfig.h"
 
-// The chunk to allocate movie data in multiples of.
-#define DTM_BASE_LENGTH (1024)
-
 static std::mutex cs_frameSkip;
 
 namespace Movie
@@ -75,7 +74,6 @@ static u32 s_framesToSkip = 0, s_frameSkipCounter = 0;
 static u8 s_controllers = 0;
 static ControllerState s_padState;
 static DTMHeader tmpHeader;
-static std::vector<u8> s_temp_input;
 static u64 s_currentByte = 0;
 static u64 s_currentFrame = 0, s_totalFrames = 0;  // VI
 static u64 s_currentLagCount = 0;
@@ -108,6 +106,13 @@ static WiiManipFunction s_wii_manip_func;
 static std::string s_current_file_name;
 
 static void GetSettings();
+
+static InputLog& GetInput()
+{
+  static InputLog s_input(File::GetUserPath(D_STATESAVES_IDX) + "dtm.input");
+  return s_input;
+}
+
 static bool IsMovieHeader(u8 magic[4])
 {
   return magic[0] == 'D' && magic[1] == 'T' && magic[2] == 'M' && magic[3] == 0x1A;
@@ -577,7 +582,7 @@ bool BeginRecordingInput(int controllers)
 
     s_playMode = MODE_RECORDING;
     s_author = SConfig::GetInstance().m_strMovieAuthor;
-    s_temp_input.clear();
+    GetInput().Clear();
 
     s_currentByte = 0;
 
@@ -842,8 +847,7 @@ void RecordInput(GCPadStatus* PadStatus, int controllerID)
 
   CheckPadStatus(PadStatus, controllerID);
 
-  s_temp_input.resize(s_currentByte + sizeof(ControllerState));
-  memcpy(&s_temp_input[s_currentByte], &s_padState, sizeof(ControllerState));
+  GetInput().Write(s_currentByte, &s_padState, sizeof(ControllerState));
   s_currentByte += sizeof(ControllerState);
 }
 
@@ -863,9 +867,9 @@ void RecordWiimote(int wiimote, u8* data, u8 size)
     return;
 
   InputUpdate();
-  s_temp_input.resize(s_currentByte + size + 1);
-  s_temp_input[s_currentByte++] = size;
-  memcpy(&s_temp_input[s_currentByte], data, size);
+  GetInput().Write(s_currentByte, &size, 1);
+  s_currentByte++;
+  GetInput().Write(s_currentByte, data, size);
   s_currentByte += size;
 }
 
@@ -915,6 +919,14 @@ bool PlayInput(const std::string& filename)
     PanicAlertT("Invalid recording file");
     return false;
   }
+  recording_file.Close();
+
+  // The input is read from a mapping of the file as it's played back.
+  if (!GetInput().MapFile(filename, sizeof(DTMHeader)))
+  {
+    PanicAlertT("Failed to read %s", filename.c_str());
+    return false;
+  }
 
   ReadHeader();
   s_totalFrames = tmpHeader.frameCount;
@@ -932,10 +944,7 @@ bool PlayInput(const std::string& filename)
 
   Core::UpdateWantDeterminism();
 
-  s_temp_input.resize(recording_file.GetSize() - 256);
-  recording_file.ReadBytes(s_temp_input.data(), s_temp_input.size());
   s_currentByte = 0;
-  recording_file.Close();
 
   // Load savestate (and skip to frame data)
   if (tmpHeader.bFromSaveState)
@@ -996,6 +1005,8 @@ void LoadInput(const std::string& filename)
     ChangeWiiPads(true);
 
   u64 totalSavedBytes = t_record.GetSize() - 256;
+  t_record.Close();
+  InputLog& input = GetInput();
 
   bool afterEnd = false;
   // This can only happen if the user manually deletes data from the dtm.
@@ -1008,42 +1019,45 @@ void LoadInput(const std::string& filename)
     afterEnd = true;
   }
 
-  if (!s_bReadOnly || s_temp_input.empty())
+  if (!s_bReadOnly || input.IsEmpty())
   {
     s_totalFrames = tmpHeader.frameCount;
     s_totalLagCount = tmpHeader.lagCount;
     s_totalInputCount = tmpHeader.inputCount;
     s_totalTickCount = s_tickCountAtLastInput = tmpHeader.tickCount;
 
-    s_temp_input.resize(static_cast<size_t>(totalSavedBytes));
-    t_record.ReadBytes(s_temp_input.data(), s_temp_input.size());
+    // Copied rather than mapped, since the file belongs to a savestate slot that can be
+    // overwritten or renamed while the input is in use.
+    if (!input.CopyFile(filename, sizeof(DTMHeader)))
+    {
+      PanicAlertT("Failed to read %s", filename.c_str());
+      EndPlayInput(false);
+      return;
+    }
   }
   else if (s_currentByte > 0)
   {
     if (s_currentByte > totalSavedBytes)
     {
     }
-    else if (s_currentByte > s_temp_input.size())
+    else if (s_currentByte > input.GetSize())
     {
       afterEnd = true;
       PanicAlertT("Warning: You loaded a save that's after the end of the current movie. (byte %u "
                   "> %zu) (input %u > %u). You should load another save before continuing, or load "
                   "this state with read-only mode off.",
-                  (u32)s_currentByte + 256, s_temp_input.size() + 256, (u32)s_currentInputCount,
-                  (u32)s_totalInputCount);
+                  (u32)s_currentByte + 256, static_cast<size_t>(input.GetSize()) + 256,
+                  (u32)s_currentInputCount, (u32)s_totalInputCount);
     }
-    else if (s_currentByte > 0 && !s_temp_input.empty())
+    else if (s_currentByte > 0 && !input.IsEmpty())
     {
       // verify identical from movie start to the save's current frame
-      std::vector<u8> movInput(s_currentByte);
-      t_record.ReadArray(movInput.data(), movInput.size());
+      File::MappedFile movie_file(filename);
+      const u8* movInput = movie_file.GetPointer(sizeof(DTMHeader), s_currentByte);
+      const u64 mismatch_index = movInput ? input.FindMismatch(movInput, s_currentByte) : 0;
 
-      const auto result = std::mismatch(movInput.begin(), movInput.end(), s_temp_input.begin());
-
-      if (result.first != movInput.end())
+      if (movInput && mismatch_index != s_currentByte)
       {
-        const ptrdiff_t mismatch_index = std::distance(movInput.begin(), result.first);
-
         // this is a "you did something wrong" alert for the user's benefit.
         // we'll try to say what's going on in excruciating detail, otherwise the user might not
         // believe us.
@@ -1057,17 +1071,19 @@ void LoadInput(const std::string& filename)
                       "read-only mode off. Otherwise you'll probably get a desync.",
                       byte_offset, byte_offset);
 
-          std::copy(movInput.begin(), movInput.end(), s_temp_input.begin());
+          input.ReplaceStart(movInput, static_cast<size_t>(s_currentByte));
         }
         else
         {
-          const ptrdiff_t frame = mismatch_index / sizeof(ControllerState);
-          ControllerState curPadState;
-          memcpy(&curPadState, &s_temp_input[frame * sizeof(ControllerState)],
-                 sizeof(ControllerState));
-          ControllerState movPadState;
-          memcpy(&movPadState, &s_temp_input[frame * sizeof(ControllerState)],
-                 sizeof(ControllerState));
+          const ptrdiff_t frame = static_cast<ptrdiff_t>(mismatch_index / sizeof(ControllerState));
+          ControllerState curPadState = {};
+          input.Read(frame * sizeof(ControllerState), &curPadState, sizeof(ControllerState));
+          ControllerState movPadState = {};
+          if ((frame + 1) * sizeof(ControllerState) <= s_currentByte)
+          {
+            memcpy(&movPadState, &movInput[frame * sizeof(ControllerState)],
+                   sizeof(ControllerState));
+          }
           PanicAlertT(
               "Warning: You loaded a save whose movie mismatches on frame %td. You should load "
               "another save before continuing, or load this state with read-only mode off. "
@@ -1098,7 +1114,6 @@ void LoadInput(const std::string& filename)
       }
     }
   }
-  t_record.Close();
 
   s_bSaveConfig = tmpHeader.bSaveConfig;
 
@@ -1132,7 +1147,7 @@ void LoadInput(const std::string& filename)
 // NOTE: CPU Thread
 static void CheckInputEnd()
 {
-  if (s_currentByte >= s_temp_input.size() ||
+  if (s_currentByte >= GetInput().GetSize() ||
       (CoreTiming::GetTicks() > s_totalTickCount && !IsRecordingInputFromSaveState()))
   {
     EndPlayInput(!s_bReadOnly);
@@ -1144,13 +1159,14 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 {
   // Correct playback is entirely dependent on the emulator polling the controllers
   // in the same order done during recording
-  if (!IsPlayingInput() || !IsUsingPad(controllerID) || s_temp_input.empty())
+  const InputLog& input = GetInput();
+  if (!IsPlayingInput() || !IsUsingPad(controllerID) || input.IsEmpty())
     return;
 
-  if (s_currentByte + sizeof(ControllerState) > s_temp_input.size())
+  if (!input.Read(s_currentByte, &s_padState, sizeof(ControllerState)))
   {
     PanicAlertT("Premature movie end in PlayController. %u + %zu > %zu", (u32)s_currentByte,
-                sizeof(ControllerState), s_temp_input.size());
+                sizeof(ControllerState), static_cast<size_t>(input.GetSize()));
     EndPlayInput(!s_bReadOnly);
     return;
   }
@@ -1161,7 +1177,6 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
   memset(PadStatus, 0, sizeof(GCPadStatus));
   PadStatus->err = e;
 
-  memcpy(&s_padState, &s_temp_input[s_currentByte], sizeof(ControllerState));
   s_currentByte += sizeof(ControllerState);
 
   PadStatus->triggerLeft = s_padState.TriggerL;
@@ -1245,21 +1260,21 @@ void PlayController(GCPadStatus* PadStatus, int controllerID)
 bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf, int ext,
                  const wiimote_key key)
 {
-  if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || s_temp_input.empty())
+  const InputLog& input = GetInput();
+  if (!IsPlayingInput() || !IsUsingWiimote(wiimote) || input.IsEmpty())
     return false;
 
-  if (s_currentByte > s_temp_input.size())
+  u8 sizeInMovie;
+  if (!input.Read(s_currentByte, &sizeInMovie, 1))
   {
     PanicAlertT("Premature movie end in PlayWiimote. %u > %zu", (u32)s_currentByte,
-                s_temp_input.size());
+                static_cast<size_t>(input.GetSize()));
     EndPlayInput(!s_bReadOnly);
     return false;
   }
 
   u8 size = rptf.size;
 
-  u8 sizeInMovie = s_temp_input[s_currentByte];
-
   if (size != sizeInMovie)
   {
     PanicAlertT("Fatal desync. Aborting playback. (Error in PlayWiimote: %u != %u, byte %u.)%s",
@@ -1274,15 +1289,13 @@ bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf,
 
   s_currentByte++;
 
-  if (s_currentByte + size > s_temp_input.size())
+  if (!input.Read(s_currentByte, data, size))
   {
     PanicAlertT("Premature movie end in PlayWiimote. %u + %d > %zu", (u32)s_currentByte, size,
-                s_temp_input.size());
+                static_cast<size_t>(input.GetSize()));
     EndPlayInput(!s_bReadOnly);
     return false;
   }
-
-  memcpy(data, &s_temp_input[s_currentByte], size);
   s_currentByte += size;
 
   s_currentInputCount++;
@@ -1330,6 +1343,9 @@ void EndPlayInput(bool cont)
 // NOTE: Save State + Host Thread
 void SaveRecording(const std::string& filename)
 {
+  // Truncating the file that is being played back would pull the input from under us.
+  GetInput().Detach(filename);
+
   File::IOFile save_record(filename, "wb");
   // Create the real header now and write it
   DTMHeader header;
@@ -1371,7 +1387,7 @@ void SaveRecording(const std::string& filename)
 
   save_record.WriteArray(&header, 1);
 
-  bool success = save_record.WriteBytes(s_temp_input.data(), s_temp_input.size());
+  bool success = GetInput().WriteTo(save_record);
 
   if (success && s_bRecordingFromSaveState)
   {
@@ -1524,6 +1540,6 @@ static void GetMD5()
 void Shutdown()
 {
   s_currentInputCount = s_totalInputCount = s_totalFrames = s_tickCountAtLastInput = 0;
-  s_temp_input.clear();
+  GetInput().Clear();
 }
 };
@@ -0,0 +1,368 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/MovieInput.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/MappedFile.h"
+
+namespace Movie
+{
+InputLog::InputLog(std::string journal_path) : m_journal_path(std::move(journal_path))
+{
+}
+
+InputLog::~InputLog()
+{
+  Clear();
+}
+
+void InputLog::Clear()
+{
+  m_ranges.clear();
+  m_mapped_size = 0;
+  m_chunks.clear();
+  m_chunks_size = 0;
+
+  m_source_map.reset();
+  m_source_path.clear();
+
+  m_journal_map.reset();
+  m_journal.Close();
+  m_journal_failed = false;
+  if (File::Exists(m_journal_path))
+    File::Delete(m_journal_path);
+}
+
+bool InputLog::MapFile(const std::string& filename, u64 data_offset)
+{
+  Clear();
+
+  auto map = std::make_shared<File::MappedFile>();
+  if (!map->Open(filename) || map->GetSize() < data_offset)
+    return false;
+
+  m_source_path = filename;
+  m_source_map = map;
+  AddRange(map, data_offset, map->GetSize() - data_offset);
+  return true;
+}
+
+bool InputLog::CopyFile(const std::string& filename, u64 data_offset)
+{
+  Clear();
+
+  File::IOFile file(filename, "rb");
+  if (!file || file.GetSize() < data_offset || !file.Seek(data_offset, SEEK_SET))
+    return false;
+
+  std::vector<u8> buffer(CHUNK_SIZE);
+  u64 remaining = file.GetSize() - data_offset;
+  while (remaining)
+  {
+    const size_t size = static_cast<size_t>(std::min<u64>(remaining, buffer.size()));
+    if (!file.ReadBytes(buffer.data(), size))
+      return false;
+    Append(buffer.data(), size);
+    remaining -= size;
+  }
+  return true;
+}
+
+void InputLog::Detach(const std::string& filename)
+{
+  if (!m_source_map || m_source_path != filename)
+    return;
+
+  std::vector<std::pair<size_t, u64>> copies;
+  bool success = true;
+  for (size_t i = 0; i < m_ranges.size() && success; ++i)
+  {
+    const Range& range = m_ranges[i];
+    if (range.file != m_source_map)
+      continue;
+
+    u64 offset = 0;
+    success = AppendToJournal(range.file->GetData() + range.offset, range.size, &offset);
+    copies.emplace_back(i, offset);
+  }
+
+  if (!copies.empty())
+  {
+    if (success && MapJournal())
+    {
+      for (const auto& copy : copies)
+      {
+        m_ranges[copy.first].file = m_journal_map;
+        m_ranges[copy.first].offset = copy.second;
+      }
+    }
+    else
+    {
+      LoadIntoMemory();
+    }
+  }
+
+  m_source_map.reset();
+  m_source_path.clear();
+}
+
+bool InputLog::Read(u64 offset, void* data, size_t size) const
+{
+  if (offset > GetSize() || size > GetSize() - offset)
+    return false;
+
+  u8* out = static_cast<u8*>(data);
+  ForEachPiece(offset, size, [&out](const u8* piece, size_t piece_size) {
+    std::memcpy(out, piece, piece_size);
+    out += piece_size;
+    return true;
+  });
+  return true;
+}
+
+void InputLog::Write(u64 offset, const void* data, size_t size)
+{
+  Truncate(offset);
+  Append(static_cast<const u8*>(data), size);
+}
+
+void InputLog::ReplaceStart(const void* data, size_t size)
+{
+  // Only the mapped ranges can be cut at arbitrary offsets.
+  if (size > m_mapped_size)
+    Spill();
+
+  u64 offset;
+  if (size > m_mapped_size || !AppendToJournal(static_cast<const u8*>(data), size, &offset) ||
+      !MapJournal())
+  {
+    LoadIntoMemory();
+    std::vector<u8> rest(static_cast<size_t>(GetSize() - size));
+    Read(size, rest.data(), rest.size());
+    Truncate(0);
+    Append(static_cast<const u8*>(data), size);
+    Append(rest.data(), rest.size());
+    return;
+  }
+
+  std::vector<Range> ranges;
+  ranges.push_back({m_journal_map, offset, size});
+  u64 skip = size;
+  for (const Range& range : m_ranges)
+  {
+    if (skip >= range.size)
+    {
+      skip -= range.size;
+      continue;
+    }
+    ranges.push_back({range.file, range.offset + skip, range.size - skip});
+    skip = 0;
+  }
+  m_ranges = std::move(ranges);
+}
+
+u64 InputLog::FindMismatch(const u8* data, u64 size) const
+{
+  u64 offset = 0;
+  ForEachPiece(0, size, [&](const u8* piece, size_t piece_size) {
+    const auto result = std::mismatch(piece, piece + piece_size, data + offset);
+    offset += static_cast<u64>(result.first - piece);
+    return result.first == piece + piece_size;
+  });
+  return offset;
+}
+
+bool InputLog::WriteTo(File::IOFile& file) const
+{
+  bool success = true;
+  ForEachPiece(0, GetSize(), [&](const u8* piece, size_t piece_size) {
+    success = file.WriteBytes(piece, piece_size);
+    return success;
+  });
+  return success;
+}
+
+void InputLog::Truncate(u64 size)
+{
+  if (size >= m_mapped_size)
+  {
+    m_chunks_size = std::min(size - m_mapped_size, m_chunks_size);
+    m_chunks.resize(static_cast<size_t>((m_chunks_size + CHUNK_SIZE - 1) / CHUNK_SIZE));
+    return;
+  }
+
+  m_chunks.clear();
+  m_chunks_size = 0;
+
+  u64 start = 0;
+  for (size_t i = 0; i < m_ranges.size(); ++i)
+  {
+    if (size <= start + m_ranges[i].size)
+    {
+      m_ranges[i].size = size - start;
+      m_ranges.resize(m_ranges[i].size ? i + 1 : i);
+      break;
+    }
+    start += m_ranges[i].size;
+  }
+  m_mapped_size = size;
+}
+
+void InputLog::Append(const u8* data, size_t size)
+{
+  while (size)
+  {
+    const size_t index = static_cast<size_t>(m_chunks_size / CHUNK_SIZE);
+    const size_t chunk_offset = static_cast<size_t>(m_chunks_size % CHUNK_SIZE);
+    if (index == m_chunks.size())
+      m_chunks.emplace_back(new u8[CHUNK_SIZE]);
+
+    const size_t copy_size = std::min(CHUNK_SIZE - chunk_offset, size);
+    std::memcpy(&m_chunks[index][chunk_offset], data, copy_size);
+    m_chunks_size += copy_size;
+    data += copy_size;
+    size -= copy_size;
+  }
+
+  if (m_chunks_size >= SPILL_SIZE)
+    Spill();
+}
+
+void InputLog::Spill()
+{
+  if (!m_chunks_size || m_journal_failed)
+    return;
+
+  u64 offset = 0;
+  for (size_t i = 0; i < m_chunks.size(); ++i)
+  {
+    const u64 size = std::min<u64>(CHUNK_SIZE, m_chunks_size - i * CHUNK_SIZE);
+    u64 chunk_offset;
+    if (!AppendToJournal(m_chunks[i].get(), size, &chunk_offset))
+      return;
+    if (i == 0)
+      offset = chunk_offset;
+  }
+
+  if (!MapJournal())
+    return;
+
+  AddRange(m_journal_map, offset, m_chunks_size);
+  m_chunks.clear();
+  m_chunks_size = 0;
+}
+
+bool InputLog::AppendToJournal(const u8* data, u64 size, u64* offset)
+{
+  if (m_journal_failed)
+    return false;
+
+  if (!m_journal.IsOpen() && !m_journal.Open(m_journal_path, "wb"))
+  {
+    ERROR_LOG(CORE, "Failed to create the movie input journal %s", m_journal_path.c_str());
+    m_journal_failed = true;
+    return false;
+  }
+
+  // A failed write may have written part of the data, which is then simply not used.
+  *offset = m_journal.Tell();
+  if (!m_journal.WriteBytes(data, static_cast<size_t>(size)))
+  {
+    ERROR_LOG(CORE, "Failed to write to the movie input journal %s", m_journal_path.c_str());
+    m_journal_failed = true;
+    return false;
+  }
+  return true;
+}
+
+bool InputLog::MapJournal()
+{
+  auto map = std::make_shared<File::MappedFile>();
+  if (!m_journal.Flush() || !map->Open(m_journal_path))
+  {
+    ERROR_LOG(CORE, "Failed to map the movie input journal %s", m_journal_path.c_str());
+    m_journal_failed = true;
+    return false;
+  }
+
+  // The new mapping covers everything the old one did.
+  for (Range& range : m_ranges)
+  {
+    if (range.file == m_journal_map)
+      range.file = map;
+  }
+  m_journal_map = std::move(map);
+  return true;
+}
+
+void InputLog::LoadIntoMemory()
+{
+  std::vector<u8> data(static_cast<size_t>(GetSize()));
+  Read(0, data.data(), data.size());
+
+  m_ranges.clear();
+  m_mapped_size = 0;
+  m_chunks.clear();
+  m_chunks_size = 0;
+  Append(data.data(), data.size());
+}
+
+void InputLog::AddRange(const std::shared_ptr<const File::MappedFile>& file, u64 offset, u64 size)
+{
+  if (!size)
+    return;
+
+  m_mapped_size += size;
+  if (!m_ranges.empty())
+  {
+    Range& last = m_ranges.back();
+    if (last.file == file && last.offset + last.size == offset)
+    {
+      last.size += size;
+      return;
+    }
+  }
+  m_ranges.push_back({file, offset, size});
+}
+
+template <typename Func>
+void InputLog::ForEachPiece(u64 offset, u64 size, Func&& func) const
+{
+  u64 start = 0;
+  for (const Range& range : m_ranges)
+  {
+    if (!size)
+      return;
+
+    if (offset < start + range.size)
+    {
+      const u64 range_offset = offset - start;
+      const size_t piece_size = static_cast<size_t>(std::min(range.size - range_offset, size));
+      if (!func(range.file->GetData() + range.offset + range_offset, piece_size))
+        return;
+      offset += piece_size;
+      size -= piece_size;
+    }
+    start += range.size;
+  }
+
+  while (size)
+  {
+    const u64 chunks_offset = offset - m_mapped_size;
+    const size_t index = static_cast<size_t>(chunks_offset / CHUNK_SIZE);
+    const size_t chunk_offset = static_cast<size_t>(chunks_offset % CHUNK_SIZE);
+    const size_t piece_size = static_cast<size_t>(std::min<u64>(CHUNK_SIZE - chunk_offset, size));
+    if (!func(&m_chunks[index][chunk_offset], piece_size))
+      return;
+    offset += piece_size;
+    size -= piece_size;
+  }
+}
+}  // namespace Movie
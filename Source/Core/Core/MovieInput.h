@@ -0,0 +1,100 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+
+namespace File
+{
+class MappedFile;
+}
+
+namespace Movie
+{
+// The input data of a movie, without the DTM header.
+//
+// Recorded input is appended to fixed-size chunks in memory. Once those add up to SPILL_SIZE,
+// they are appended to a journal file and read back through a memory mapping, so recording
+// never reallocates and long recordings don't stay in memory. Movies that are played back are
+// mapped in place. The input is a list of ranges of those mappings, so truncating it or
+// replacing its beginning doesn't copy the rest.
+class InputLog
+{
+public:
+  static constexpr size_t CHUNK_SIZE = 0x10000;
+  static constexpr size_t SPILL_SIZE = 0x100000;
+
+  explicit InputLog(std::string journal_path);
+  ~InputLog();
+
+  InputLog(const InputLog&) = delete;
+  InputLog& operator=(const InputLog&) = delete;
+
+  // Also deletes the journal.
+  void Clear();
+  // Plays back the input of a file, which starts at data_offset, from a mapping of it.
+  bool MapFile(const std::string& filename, u64 data_offset);
+  // Like MapFile, but copies the input to the journal so that the file isn't kept open.
+  bool CopyFile(const std::string& filename, u64 data_offset);
+  // Copies the input that still comes from filename to the journal, so that the file can be
+  // overwritten.
+  void Detach(const std::string& filename);
+
+  u64 GetSize() const { return m_mapped_size + m_chunks_size; }
+  bool IsEmpty() const { return GetSize() == 0; }
+
+  // Returns false without reading anything if the range isn't entirely in the input.
+  bool Read(u64 offset, void* data, size_t size) const;
+  // Discards the input from offset on (which must not be past the end) and appends data there.
+  void Write(u64 offset, const void* data, size_t size);
+  // Replaces the first size bytes of the input, which must have at least that many.
+  void ReplaceStart(const void* data, size_t size);
+  // Returns the offset of the first byte that differs from data, or size if they're the same.
+  u64 FindMismatch(const u8* data, u64 size) const;
+
+  bool WriteTo(File::IOFile& file) const;
+
+private:
+  struct Range
+  {
+    std::shared_ptr<const File::MappedFile> file;
+    u64 offset;
+    u64 size;
+  };
+
+  void Truncate(u64 size);
+  void Append(const u8* data, size_t size);
+  void Spill();
+  // Appends data to the journal and returns its offset in *offset.
+  bool AppendToJournal(const u8* data, u64 size, u64* offset);
+  bool MapJournal();
+  // Fallback for when the journal can't be used.
+  void LoadIntoMemory();
+  void AddRange(const std::shared_ptr<const File::MappedFile>& file, u64 offset, u64 size);
+
+  // Calls func(pointer, size) for each contiguous piece of [offset, offset + size).
+  template <typename Func>
+  void ForEachPiece(u64 offset, u64 size, Func&& func) const;
+
+  std::vector<Range> m_ranges;
+  u64 m_mapped_size = 0;
+  std::vector<std::unique_ptr<u8[]>> m_chunks;
+  u64 m_chunks_size = 0;
+
+  std::string m_journal_path;
+  File::IOFile m_journal;
+  std::shared_ptr<const File::MappedFile> m_journal_map;
+  bool m_journal_failed = false;
+
+  std::string m_source_path;
+  std::shared_ptr<const File::MappedFile> m_source_map;
+};
+}  // namespace Movie
@@ -177,9 +177,12 @@ void CachedInterpreter::Jit(u32 address)
     ClearCache();
   }
 
-  u32 nextPC = analyzer.Analyze(PC, &code_block, &code_buffer, code_buffer.GetSize());
+  u32 nextPC = analyzer.Analyze(address, &code_block, &code_buffer, code_buffer.GetSize());
   if (code_block.m_memory_exception)
   {
+    if (js.compilingAheadOfTime)
+      return;
+
     // Address of instruction could not be translated
     NPC = nextPC;
     PowerPC::ppcState.Exceptions |= EXCEPTION_ISI;
@@ -188,9 +191,9 @@ void CachedInterpreter::Jit(u32 address)
     return;
   }
 
-  JitBlock* b = m_block_cache.AllocateBlock(PC);
+  JitBlock* b = m_block_cache.AllocateBlock(address);
 
-  js.blockStart = PC;
+  js.blockStart = address;
   js.firstFPInstructionFound = false;
   js.fifoBytesSinceCheck = 0;
   js.downcountAmount = 0;
@@ -616,6 +616,9 @@ void Jit64::Jit(u32 em_address)
 
   if (code_block.m_memory_exception)
   {
+    if (js.compilingAheadOfTime)
+      return;
+
     // Address of instruction could not be translated
     NPC = nextPC;
     PowerPC::ppcState.Exceptions |= EXCEPTION_ISI;
@@ -531,7 +531,7 @@ void JitArm64::SingleStep()
   pExecAddr();
 }
 
-void JitArm64::Jit(u32)
+void JitArm64::Jit(u32 em_address)
 {
   if (m_cleanup_after_stackfault)
   {
@@ -549,7 +549,6 @@ void JitArm64::Jit(u32)
   }
 
   int blockSize = code_buffer.GetSize();
-  u32 em_address = PowerPC::ppcState.pc;
 
   if (SConfig::GetInstance().bEnableDebugging)
   {
@@ -564,6 +563,9 @@ void JitArm64::Jit(u32)
 
   if (code_block.m_memory_exception)
   {
+    if (js.compilingAheadOfTime)
+      return;
+
     // Address of instruction could not be translated
     NPC = nextPC;
     PowerPC::ppcState.Exceptions |= EXCEPTION_ISI;
@@ -39,7 +39,7 @@ public:
   void Run() override;
   void SingleStep() override;
 
-  void Jit(u32) override;
+  void Jit(u32 em_address) override;
 
   const char* GetName() override { return "JITARM64"; }
   // OPCODES
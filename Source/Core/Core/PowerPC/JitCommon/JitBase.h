@@ -83,6 +83,9 @@ protected:
     bool carryFlagInverted;
 
     bool generatingTrampoline = false;
+    // Set while compiling blocks ahead of time. Such blocks must not raise exceptions;
+    // they are compiled normally once they are executed.
+    bool compilingAheadOfTime = false;
     u8* trampolineExceptionHandler;
 
     bool mustCheckFifo;
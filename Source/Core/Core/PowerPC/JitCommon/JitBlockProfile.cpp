@@ -0,0 +1,140 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitBlockProfile.h"
+
+#include "Common/CommonPaths.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Core/HW/Memmap.h"
+
+namespace
+{
+constexpr u32 PROFILE_MAGIC = 0x4650424A;  // "JBPF"
+constexpr u32 PROFILE_VERSION = 1;
+// Large enough for every block a game runs into in a long session, while keeping the
+// file small and the time spent compiling ahead of time bounded.
+constexpr size_t MAX_ENTRIES = 0x10000;
+
+struct ProfileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_entries;
+  u32 reserved;
+};
+
+const u8* GetRAMPointer(u32 address, u32 size)
+{
+  if (static_cast<u64>(address) + size <= Memory::REALRAM_SIZE)
+    return Memory::m_pRAM + address;
+
+  if (Memory::m_pEXRAM && (address >> 28) == 0x1 &&
+      static_cast<u64>(address & 0x0fffffff) + size <= Memory::EXRAM_SIZE)
+  {
+    return Memory::m_pEXRAM + (address & Memory::EXRAM_MASK);
+  }
+
+  return nullptr;
+}
+
+// FNV-1a
+u64 Hash(const u8* data, size_t size)
+{
+  u64 hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; ++i)
+    hash = (hash ^ data[i]) * 0x100000001b3ULL;
+  return hash;
+}
+}  // namespace
+
+std::string JitBlockProfile::GetFilename(const std::string& game_id)
+{
+  return File::GetUserPath(D_CACHE_IDX) + "JitProfiles" DIR_SEP + game_id + ".jbp";
+}
+
+bool JitBlockProfile::HashInstructions(u32 physical_address,
+                                       const std::set<u32>& physical_addresses,
+                                       u32* num_instructions, u64* hash)
+{
+  auto it = physical_addresses.find(physical_address);
+  if (it == physical_addresses.end())
+    return false;
+
+  u32 count = 1;
+  for (u32 previous = *it++; it != physical_addresses.end() && *it == previous + 4;
+       previous = *it++)
+  {
+    count++;
+  }
+
+  const u8* data = GetRAMPointer(physical_address, count * 4);
+  if (!data)
+    return false;
+
+  *num_instructions = count;
+  *hash = Hash(data, count * 4);
+  return true;
+}
+
+bool JitBlockProfile::IsUnchanged(const Entry& entry)
+{
+  const u8* data = GetRAMPointer(entry.physical_address, entry.num_instructions * 4);
+  return data && Hash(data, entry.num_instructions * 4) == entry.hash;
+}
+
+bool JitBlockProfile::Load(const std::string& filename)
+{
+  Clear();
+
+  File::IOFile file(filename, "rb");
+  ProfileHeader header;
+  if (!file.ReadArray(&header, 1) || header.magic != PROFILE_MAGIC ||
+      header.version != PROFILE_VERSION || header.num_entries > MAX_ENTRIES)
+  {
+    return false;
+  }
+
+  std::vector<Entry> entries(header.num_entries);
+  if (!file.ReadArray(entries.data(), entries.size()))
+    return false;
+
+  for (const Entry& entry : entries)
+    Add(entry);
+
+  INFO_LOG(DYNA_REC, "Loaded %zu blocks from JIT profile %s", m_entries.size(),
+           filename.c_str());
+  return true;
+}
+
+bool JitBlockProfile::Save(const std::string& filename) const
+{
+  File::CreateFullPath(filename);
+  File::IOFile file(filename, "wb");
+
+  ProfileHeader header = {PROFILE_MAGIC, PROFILE_VERSION, static_cast<u32>(m_entries.size()), 0};
+  if (!file.WriteArray(&header, 1) || !file.WriteArray(m_entries.data(), m_entries.size()))
+  {
+    ERROR_LOG(DYNA_REC, "Failed to write JIT profile %s", filename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+void JitBlockProfile::Clear()
+{
+  m_entries.clear();
+  m_keys.clear();
+}
+
+void JitBlockProfile::Add(const Entry& entry)
+{
+  if (m_entries.size() >= MAX_ENTRIES)
+    return;
+
+  if (m_keys.emplace(entry.effective_address, entry.msr_bits, entry.hash).second)
+    m_entries.push_back(entry);
+}
@@ -0,0 +1,50 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// The blocks a game compiled during a session, stored per game ID so that the next session
+// can compile them ahead of time instead of stuttering when they are first executed.
+class JitBlockProfile
+{
+public:
+  struct Entry
+  {
+    u32 effective_address;
+    u32 msr_bits;
+    u32 physical_address;
+    // The number of instructions that directly follow the entry point in memory,
+    // and a hash of them. This is checked before compiling the block ahead of time.
+    u32 num_instructions;
+    u64 hash;
+  };
+
+  static std::string GetFilename(const std::string& game_id);
+
+  // Hashes the instructions of a block that follow its entry point without gaps.
+  // Returns false if they aren't in MEM1 or MEM2.
+  static bool HashInstructions(u32 physical_address, const std::set<u32>& physical_addresses,
+                               u32* num_instructions, u64* hash);
+  // Checks that the instructions at the address of the entry still match its hash.
+  static bool IsUnchanged(const Entry& entry);
+
+  bool Load(const std::string& filename);
+  bool Save(const std::string& filename) const;
+  void Clear();
+
+  // Blocks are kept in the order they were first added. Duplicates are ignored.
+  void Add(const Entry& entry);
+  const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+private:
+  std::vector<Entry> m_entries;
+  std::set<std::tuple<u32, u32, u64>> m_keys;
+};
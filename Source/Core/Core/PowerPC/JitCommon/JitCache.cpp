@@ -11,16 +11,21 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstring>
 #include <functional>
 #include <map>
 #include <set>
+#include <string>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/JitRegister.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/Movie.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -31,13 +36,41 @@
 
 using namespace Gen;
 
+// Compiling blocks ahead of time takes at most this long at once, and only starts again
+// after the interval has passed, so it can't take over the CPU thread.
+constexpr std::chrono::microseconds PROFILED_COMPILE_TIME_BUDGET{1000};
+constexpr std::chrono::microseconds PROFILED_COMPILE_INTERVAL{8000};
+
+// Erases every address in [address, address + length) from the set, visiting whichever of the
+// two is smaller.
+static void EraseAddressesInRange(std::unordered_set<u32>& addresses, u32 address, u32 length)
+{
+  const u64 end = static_cast<u64>(address) + length;
+  if (addresses.size() < length / 4)
+  {
+    for (auto it = addresses.begin(); it != addresses.end();)
+    {
+      if (*it >= address && *it < end)
+        it = addresses.erase(it);
+      else
+        ++it;
+    }
+  }
+  else
+  {
+    for (u64 i = address; i < end; i += 4)
+      addresses.erase(static_cast<u32>(i));
+  }
+}
+
 bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 {
   return physical_addresses.lower_bound(address) !=
          physical_addresses.lower_bound(address + length);
 }
 
-JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
+JitBaseBlockCache::JitBaseBlockCache(JitBase& jit)
+    : m_jit{jit}, block_range_map((1ULL << 32) >> BLOCK_RANGE_PAGE_SHIFT)
 {
 }
 
@@ -47,12 +80,36 @@ void JitBaseBlockCache::Init()
 {
   JitRegister::Init(SConfig::GetInstance().m_perfDir);
 
+  m_invalidation_stats = {};
+  m_invalidation_stats.start_frame = Movie::GetCurrentFrame();
+
+  m_block_profile.Clear();
+  m_loaded_block_profile.Clear();
+  m_block_profile_loaded = false;
+  m_next_profiled_block = 0;
+
   Clear();
 }
 
 void JitBaseBlockCache::Shutdown()
 {
   JitRegister::Shutdown();
+
+  const std::string game_id = SConfig::GetInstance().GetGameID();
+  if (SConfig::GetInstance().bJITWarmStart && !game_id.empty() &&
+      !m_block_profile.GetEntries().empty())
+  {
+    // Keep the blocks of the earlier sessions that weren't reached this time. The profile is only
+    // loaded once the first blocks get compiled ahead of time, which may not have happened yet.
+    if (!m_block_profile_loaded)
+    {
+      m_block_profile_loaded = true;
+      m_loaded_block_profile.Load(JitBlockProfile::GetFilename(game_id));
+    }
+    for (const JitBlockProfile::Entry& entry : m_loaded_block_profile.GetEntries())
+      m_block_profile.Add(entry);
+    m_block_profile.Save(JitBlockProfile::GetFilename(game_id));
+  }
 }
 
 // This clears the JIT cache. It's called from JitCache.cpp when the JIT cache
@@ -70,7 +127,8 @@ void JitBaseBlockCache::Clear()
   }
   block_map.clear();
   links_to.clear();
-  block_range_map.clear();
+  for (auto& page : block_range_map)
+    page.reset();
 
   valid_block.ClearAll();
 
@@ -115,11 +173,21 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
 
   block.physical_addresses = physical_addresses;
 
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
   for (u32 addr : physical_addresses)
-  {
     valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
+  AddBlockToRanges(&block);
+
+  if (SConfig::GetInstance().bJITWarmStart)
+  {
+    JitBlockProfile::Entry entry;
+    entry.effective_address = block.effectiveAddress;
+    entry.msr_bits = block.msrBits;
+    entry.physical_address = block.physicalAddress;
+    if (JitBlockProfile::HashInstructions(block.physicalAddress, physical_addresses,
+                                          &entry.num_instructions, &entry.hash))
+    {
+      m_block_profile.Add(entry);
+    }
   }
 
   if (block_link)
@@ -211,61 +279,164 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
     // being in the right place between instructions).
     if (!forced)
     {
-      for (u32 i = address; i < address + length; i += 4)
-      {
-        m_jit.js.fifoWriteAddresses.erase(i);
-        m_jit.js.pairedQuantizeAddresses.erase(i);
-      }
+      EraseAddressesInRange(m_jit.js.fifoWriteAddresses, address, length);
+      EraseAddressesInRange(m_jit.js.pairedQuantizeAddresses, address, length);
     }
   }
 }
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
+  m_invalidation_stats.invalidations++;
+
   // Iterate over all macro blocks which overlap the given range.
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
+  const u64 end = static_cast<u64>(address) + length;
+  u64 range = address & ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  while (range < end)
   {
-    // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    std::vector<JitBlock*>* blocks = GetBlockRange(static_cast<u32>(range));
+    if (!blocks)
     {
-      JitBlock* block = *iter;
-      if (block->OverlapsPhysicalRange(address, length))
+      // No code in this page, skip to the next one.
+      range = (range | (BLOCK_RANGE_PAGE_SIZE - 1)) + 1;
+      continue;
+    }
+
+    // Iterate over all blocks in the macro block. Removing a block from its ranges moves
+    // another block into its slot, so the index only advances when nothing was removed.
+    size_t i = 0;
+    while (i < blocks->size())
+    {
+      JitBlock* block = (*blocks)[i];
+      if (!block->OverlapsPhysicalRange(address, length))
       {
-        // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
-
-        // And remove the block.
-        DestroyBlock(*block);
-        auto block_map_iter = block_map.equal_range(block->physicalAddress);
-        while (block_map_iter.first != block_map_iter.second)
-        {
-          if (&block_map_iter.first->second == block)
-          {
-            block_map.erase(block_map_iter.first);
-            break;
-          }
-          block_map_iter.first++;
-        }
-        iter = start->second.erase(iter);
+        i++;
+        continue;
       }
-      else
+
+      RemoveBlockFromRanges(block);
+
+      DestroyBlock(*block);
+      auto block_map_iter = block_map.equal_range(block->physicalAddress);
+      while (block_map_iter.first != block_map_iter.second)
       {
-        iter++;
+        if (&block_map_iter.first->second == block)
+        {
+          block_map.erase(block_map_iter.first);
+          break;
+        }
+        block_map_iter.first++;
       }
+
+      m_invalidation_stats.invalidated_blocks++;
     }
 
-    // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+    range += BLOCK_RANGE_MAP_ELEMENTS;
+  }
+}
+
+void JitBaseBlockCache::CompileProfiledBlocks()
+{
+  const SConfig& config = SConfig::GetInstance();
+  if (!config.bJITWarmStart || config.bEnableDebugging)
+    return;
+
+  // The game ID isn't known yet when the JIT is initialized.
+  if (!m_block_profile_loaded)
+  {
+    m_block_profile_loaded = true;
+    m_loaded_block_profile.Load(JitBlockProfile::GetFilename(config.GetGameID()));
+  }
+
+  const std::vector<JitBlockProfile::Entry>& entries = m_loaded_block_profile.GetEntries();
+  if (m_next_profiled_block >= entries.size())
+    return;
+
+  const auto start = std::chrono::steady_clock::now();
+  if (start - m_last_profiled_compile < PROFILED_COMPILE_INTERVAL)
+    return;
+
+  const u32 msr_bits = MSR & JIT_CACHE_MSR_MASK;
+  m_jit.js.compilingAheadOfTime = true;
+  while (m_next_profiled_block < entries.size() &&
+         std::chrono::steady_clock::now() - start < PROFILED_COMPILE_TIME_BUDGET)
+  {
+    const JitBlockProfile::Entry& entry = entries[m_next_profiled_block++];
+
+    // Blocks for other address translation modes can't be compiled from here.
+    if (entry.msr_bits != msr_bits || GetBlockFromStartAddress(entry.effective_address, MSR))
+      continue;
+
+    // Skip code that has been moved or replaced since the profile was recorded.
+    const auto translated = PowerPC::JitCache_TranslateAddress(entry.effective_address);
+    if (!translated.valid || translated.address != entry.physical_address ||
+        !JitBlockProfile::IsUnchanged(entry))
+    {
+      continue;
+    }
+
+    m_jit.Jit(entry.effective_address);
+  }
+  m_jit.js.compilingAheadOfTime = false;
+
+  m_last_profiled_compile = std::chrono::steady_clock::now();
+}
+
+std::vector<JitBlock*>* JitBaseBlockCache::GetBlockRange(u32 address)
+{
+  BlockRangePage* page = block_range_map[address >> BLOCK_RANGE_PAGE_SHIFT].get();
+  if (!page)
+    return nullptr;
+  return &(*page)[(address & (BLOCK_RANGE_PAGE_SIZE - 1)) / BLOCK_RANGE_MAP_ELEMENTS];
+}
+
+std::vector<JitBlock*>& JitBaseBlockCache::GetOrCreateBlockRange(u32 address)
+{
+  std::unique_ptr<BlockRangePage>& page = block_range_map[address >> BLOCK_RANGE_PAGE_SHIFT];
+  if (!page)
+    page = std::make_unique<BlockRangePage>();
+  return (*page)[(address & (BLOCK_RANGE_PAGE_SIZE - 1)) / BLOCK_RANGE_MAP_ELEMENTS];
+}
+
+void JitBaseBlockCache::AddBlockToRanges(JitBlock* block)
+{
+  // physical_addresses is sorted, so the addresses in each macro block are adjacent.
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  u32 last_range = 0;
+  bool first = true;
+  for (u32 addr : block->physical_addresses)
+  {
+    const u32 range = addr & range_mask;
+    if (!first && range == last_range)
+      continue;
+    GetOrCreateBlockRange(range).push_back(block);
+    last_range = range;
+    first = false;
+  }
+}
+
+void JitBaseBlockCache::RemoveBlockFromRanges(JitBlock* block)
+{
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  u32 last_range = 0;
+  bool first = true;
+  for (u32 addr : block->physical_addresses)
+  {
+    const u32 range = addr & range_mask;
+    if (!first && range == last_range)
+      continue;
+    last_range = range;
+    first = false;
+
+    std::vector<JitBlock*>* blocks = GetBlockRange(range);
+    if (!blocks)
+      continue;
+    auto it = std::find(blocks->begin(), blocks->end(), block);
+    if (it != blocks->end())
+    {
+      *it = blocks->back();
+      blocks->pop_back();
+    }
   }
 }
 
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
 #include <cstring>
 #include <functional>
 #include <map>
@@ -14,6 +15,7 @@
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitBlockProfile.h"
 
 class JitBase;
 
@@ -121,6 +123,15 @@ public:
   static constexpr u32 FAST_BLOCK_MAP_ELEMENTS = 0x10000;
   static constexpr u32 FAST_BLOCK_MAP_MASK = FAST_BLOCK_MAP_ELEMENTS - 1;
 
+  struct InvalidationStats
+  {
+    // Number of ErasePhysicalRange calls, and of blocks that they destroyed.
+    u64 invalidations = 0;
+    u64 invalidated_blocks = 0;
+    // Movie::GetCurrentFrame() when the counters were reset.
+    u64 start_frame = 0;
+  };
+
   explicit JitBaseBlockCache(JitBase& jit);
   virtual ~JitBaseBlockCache();
 
@@ -150,8 +161,14 @@ public:
   void InvalidateICache(u32 address, u32 length, bool forced);
   void ErasePhysicalRange(u32 address, u32 length);
 
+  // Compiles some of the blocks that this game ran in an earlier session, if they haven't been
+  // compiled yet. Must only be called from the CPU thread while no block is executing.
+  void CompileProfiledBlocks();
+
   u32* GetBlockBitSet() const;
 
+  const InvalidationStats& GetInvalidationStats() const { return m_invalidation_stats; }
+
 protected:
   JitBase& m_jit;
 
@@ -166,6 +183,11 @@ private:
 
   JitBlock* MoveBlockIntoFastCache(u32 em_address, u32 msr);
 
+  std::vector<JitBlock*>* GetBlockRange(u32 address);
+  std::vector<JitBlock*>& GetOrCreateBlockRange(u32 address);
+  void AddBlockToRanges(JitBlock* block);
+  void RemoveBlockFromRanges(JitBlock* block);
+
   // Fast but risky block lookup based on fast_block_map.
   size_t FastLookupIndexForAddress(u32 address);
 
@@ -179,9 +201,24 @@ private:
 
   // Range of overlapping code indexed by a masked physical address.
   // This is used for invalidation of memory regions. The range is grouped
-  // in macro blocks of each 0x100 bytes.
+  // in macro blocks of each 0x100 bytes, which hold the blocks overlapping them.
+  // The macro blocks are stored in dense pages of 64 KiB of address space each,
+  // which are only allocated for the parts of memory that contain code.
   static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  static constexpr u32 BLOCK_RANGE_PAGE_SHIFT = 16;
+  static constexpr u32 BLOCK_RANGE_PAGE_SIZE = 1 << BLOCK_RANGE_PAGE_SHIFT;
+  using BlockRangePage =
+      std::array<std::vector<JitBlock*>, BLOCK_RANGE_PAGE_SIZE / BLOCK_RANGE_MAP_ELEMENTS>;
+  std::vector<std::unique_ptr<BlockRangePage>> block_range_map;
+
+  InvalidationStats m_invalidation_stats;
+
+  // Blocks compiled in this session, and the ones recorded by an earlier session.
+  JitBlockProfile m_block_profile;
+  JitBlockProfile m_loaded_block_profile;
+  bool m_block_profile_loaded = false;
+  size_t m_next_profiled_block = 0;
+  std::chrono::steady_clock::time_point m_last_profiled_compile;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
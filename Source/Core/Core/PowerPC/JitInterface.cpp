@@ -22,6 +22,7 @@
 #include "Common/MsgHandler.h"
 
 #include "Core/Core.h"
+#include "Core/Movie.h"
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -101,6 +102,15 @@ void WriteProfileResults(const std::string& filename)
             name.c_str(), stat.run_count, stat.cost, stat.tick_counter, percent, timePercent,
             (double)stat.tick_counter * 1000.0 / (double)prof_stats.countsPerSec, stat.block_size);
   }
+
+  const double frames = static_cast<double>(std::max<u64>(prof_stats.frame_count, 1));
+  fprintf(f.GetHandle(),
+          "\nframes\tinvalidations\tinvalidationsPerFrame\tinvalidatedBlocks\t"
+          "invalidatedBlocksPerFrame\n");
+  fprintf(f.GetHandle(), "%" PRIu64 "\t%" PRIu64 "\t%.2f\t%" PRIu64 "\t%.2f\n",
+          prof_stats.frame_count, prof_stats.invalidation_count,
+          prof_stats.invalidation_count / frames, prof_stats.invalidated_block_count,
+          prof_stats.invalidated_block_count / frames);
 }
 
 void GetProfileResults(ProfileStats* prof_stats)
@@ -131,6 +141,12 @@ void GetProfileResults(ProfileStats* prof_stats)
   });
 
   sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
+
+  const JitBaseBlockCache::InvalidationStats& invalidation_stats =
+      g_jit->GetBlockCache()->GetInvalidationStats();
+  prof_stats->invalidation_count = invalidation_stats.invalidations;
+  prof_stats->invalidated_block_count = invalidation_stats.invalidated_blocks;
+  prof_stats->frame_count = Movie::GetCurrentFrame() - invalidation_stats.start_frame;
   if (old_state == Core::State::Running)
     Core::SetState(Core::State::Running);
 }
@@ -210,6 +226,12 @@ void ClearSafe()
     g_jit->GetBlockCache()->Clear();
 }
 
+void CompileProfiledBlocks()
+{
+  if (g_jit)
+    g_jit->GetBlockCache()->CompileProfiledBlocks();
+}
+
 void InvalidateICache(u32 address, u32 size, bool forced)
 {
   if (g_jit)
@@ -44,6 +44,10 @@ void ClearSafe();
 // If "forced" is true, a recompile is being requested on code that hasn't been modified.
 void InvalidateICache(u32 address, u32 size, bool forced);
 
+// Compiles blocks recorded in an earlier session of the running game ahead of time.
+// Called on the CPU thread when the emulated CPU is idle.
+void CompileProfiledBlocks();
+
 void CompileExceptionCheck(ExceptionType type);
 
 void Shutdown();
@@ -30,6 +30,10 @@ struct ProfileStats
   u64 cost_sum;
   u64 timecost_sum;
   u64 countsPerSec;
+  // JIT cache invalidations since the JIT was started, and the frames emulated since then.
+  u64 invalidation_count = 0;
+  u64 invalidated_block_count = 0;
+  u64 frame_count = 0;
 };
 
 namespace Profiler
@@ -0,0 +1,225 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/RewindBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <xxhash.h>
+
+namespace State
+{
+void RewindBuffer::SetMaxSize(size_t max_size)
+{
+  m_max_size = max_size;
+  Trim();
+}
+
+void RewindBuffer::Clear()
+{
+  m_latest.clear();
+  m_latest_section_starts.clear();
+  m_latest_section_hashes.clear();
+  m_regions.clear();
+  m_regions_size = 0;
+  m_has_latest = false;
+  m_deltas.clear();
+  m_deltas_size = 0;
+}
+
+void RewindBuffer::Push(std::vector<u8>&& state, const std::vector<size_t>& section_starts,
+                        const std::vector<MemoryRegion>& regions)
+{
+  std::vector<u64> section_hashes(section_starts.size() + 1);
+  for (size_t section = 0; section < section_hashes.size(); ++section)
+  {
+    const size_t start = GetSectionStart(section_starts, section);
+    const size_t end = GetSectionEnd(section_starts, state.size(), section);
+    section_hashes[section] = XXH64(state.data() + start, end - start, 0);
+  }
+
+  if (!m_has_latest || !HasSameRegions(regions))
+  {
+    // The deltas can't describe regions of another layout, so start over.
+    Clear();
+    m_regions.resize(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+      RegionCopy& copy = m_regions[i];
+      copy.data.assign(regions[i].data, regions[i].data + regions[i].size);
+      for (size_t offset = 0; offset < regions[i].size; offset += PAGE_SIZE)
+      {
+        const size_t size = std::min(PAGE_SIZE, regions[i].size - offset);
+        copy.page_hashes.push_back(XXH64(regions[i].data + offset, size, 0));
+      }
+      m_regions_size += copy.data.size();
+    }
+  }
+  else
+  {
+    Delta delta;
+    delta.state_size = m_latest.size();
+    delta.section_starts = m_latest_section_starts;
+
+    // Record every page of the previous snapshot that the same section of the new one doesn't
+    // reproduce exactly.
+    for (size_t section = 0; section <= m_latest_section_starts.size(); ++section)
+    {
+      const size_t start = GetSectionStart(m_latest_section_starts, section);
+      const size_t end = GetSectionEnd(m_latest_section_starts, m_latest.size(), section);
+      size_t new_start = 0;
+      size_t new_size = 0;
+      if (section <= section_starts.size())
+      {
+        new_start = GetSectionStart(section_starts, section);
+        new_size = GetSectionEnd(section_starts, state.size(), section) - new_start;
+        if (new_size == end - start && section_hashes[section] == m_latest_section_hashes[section])
+          continue;
+      }
+
+      for (size_t offset = 0; start + offset < end; offset += PAGE_SIZE)
+      {
+        const size_t size = std::min(PAGE_SIZE, end - start - offset);
+        if (offset + size <= new_size &&
+            !std::memcmp(&m_latest[start + offset], &state[new_start + offset], size))
+        {
+          continue;
+        }
+
+        delta.pages.push_back({static_cast<u32>(start + offset), static_cast<u32>(size)});
+        delta.data.insert(delta.data.end(), m_latest.begin() + start + offset,
+                          m_latest.begin() + start + offset + size);
+      }
+    }
+
+    // A region page is only touched when its hash changed: its old contents go into the delta
+    // and the copy is brought up to date.
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+      RegionCopy& copy = m_regions[i];
+      for (size_t offset = 0; offset < regions[i].size; offset += PAGE_SIZE)
+      {
+        const size_t size = std::min(PAGE_SIZE, regions[i].size - offset);
+        const u64 hash = XXH64(regions[i].data + offset, size, 0);
+        u64& old_hash = copy.page_hashes[offset / PAGE_SIZE];
+        if (hash == old_hash)
+          continue;
+
+        delta.region_pages.push_back(
+            {static_cast<u32>(i), static_cast<u32>(offset), static_cast<u32>(size)});
+        delta.data.insert(delta.data.end(), copy.data.begin() + offset,
+                          copy.data.begin() + offset + size);
+        std::memcpy(&copy.data[offset], regions[i].data + offset, size);
+        old_hash = hash;
+      }
+    }
+
+    delta.section_hashes = std::move(m_latest_section_hashes);
+    m_deltas_size += GetDeltaSize(delta);
+    m_deltas.push_back(std::move(delta));
+  }
+
+  m_latest.swap(state);
+  m_latest_section_starts = section_starts;
+  m_latest_section_hashes = std::move(section_hashes);
+  m_has_latest = true;
+  Trim();
+}
+
+bool RewindBuffer::Pop(std::vector<u8>* state, std::vector<size_t>* section_starts,
+                       const std::vector<MemoryRegion>& regions)
+{
+  if (!m_has_latest)
+    return false;
+
+  for (size_t i = 0; i < std::min(regions.size(), m_regions.size()); ++i)
+    std::memcpy(regions[i].data, m_regions[i].data.data(),
+                std::min(regions[i].size, m_regions[i].data.size()));
+
+  state->swap(m_latest);
+  if (section_starts)
+    *section_starts = m_latest_section_starts;
+  if (m_deltas.empty())
+  {
+    Clear();
+    return true;
+  }
+
+  // Rebuild the previous snapshot from the one that was just popped, one section at a time.
+  const Delta& delta = m_deltas.back();
+  m_latest.resize(delta.state_size);
+  for (size_t section = 0; section <= delta.section_starts.size(); ++section)
+  {
+    if (section > m_latest_section_starts.size())
+      break;
+
+    const size_t start = GetSectionStart(delta.section_starts, section);
+    const size_t end = GetSectionEnd(delta.section_starts, delta.state_size, section);
+    const size_t new_start = GetSectionStart(m_latest_section_starts, section);
+    const size_t new_end = GetSectionEnd(m_latest_section_starts, state->size(), section);
+    std::memcpy(m_latest.data() + start, state->data() + new_start,
+                std::min(end - start, new_end - new_start));
+  }
+
+  const u8* data = delta.data.data();
+  for (const Page& page : delta.pages)
+  {
+    std::memcpy(&m_latest[page.offset], data, page.size);
+    data += page.size;
+  }
+  for (const RegionPage& page : delta.region_pages)
+  {
+    RegionCopy& copy = m_regions[page.region];
+    std::memcpy(&copy.data[page.offset], data, page.size);
+    copy.page_hashes[page.offset / PAGE_SIZE] = XXH64(data, page.size, 0);
+    data += page.size;
+  }
+  m_latest_section_starts = delta.section_starts;
+  m_latest_section_hashes = delta.section_hashes;
+
+  m_deltas_size -= GetDeltaSize(delta);
+  m_deltas.pop_back();
+  return true;
+}
+
+size_t RewindBuffer::GetSectionStart(const std::vector<size_t>& section_starts, size_t index)
+{
+  return index == 0 ? 0 : section_starts[index - 1];
+}
+
+size_t RewindBuffer::GetSectionEnd(const std::vector<size_t>& section_starts, size_t state_size,
+                                   size_t index)
+{
+  return index < section_starts.size() ? section_starts[index] : state_size;
+}
+
+size_t RewindBuffer::GetDeltaSize(const Delta& delta)
+{
+  return delta.data.size() + delta.pages.size() * sizeof(Page) +
+         delta.region_pages.size() * sizeof(RegionPage) +
+         delta.section_starts.size() * sizeof(size_t) + delta.section_hashes.size() * sizeof(u64);
+}
+
+bool RewindBuffer::HasSameRegions(const std::vector<MemoryRegion>& regions) const
+{
+  return std::equal(regions.begin(), regions.end(), m_regions.begin(), m_regions.end(),
+                    [](const MemoryRegion& region, const RegionCopy& copy) {
+                      return region.size == copy.data.size();
+                    });
+}
+
+void RewindBuffer::Trim()
+{
+  if (m_max_size == 0)
+    return;
+
+  while (!m_deltas.empty() && GetMemoryUsage() > m_max_size)
+  {
+    m_deltas_size -= GetDeltaSize(m_deltas.front());
+    m_deltas.pop_front();
+  }
+}
+}  // namespace State
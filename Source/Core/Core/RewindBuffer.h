@@ -0,0 +1,114 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace State
+{
+// Keeps a history of serialized savestates in memory.
+//
+// Only the most recent snapshot is stored in full. For each older snapshot, only the pages that
+// differ from the snapshot that came after it are kept, so consecutive snapshots of a mostly idle
+// machine (where little of MEM1/MEM2 changed) take up a fraction of a full state.
+//
+// A snapshot can be split into sections, e.g. one per subsystem. Pages are counted from the start
+// of their section and compared with the same section of the other snapshot, so a section that
+// changes size doesn't shift the pages of the sections after it. A section whose size and hash
+// match the previous snapshot's isn't compared at all.
+//
+// Large memory regions (MEM1 and MEM2) can be passed separately instead of being serialized into
+// the state. The buffer keeps a copy of them along with a hash of each page, so a snapshot only
+// hashes the live memory and copies the pages whose hash changed.
+class RewindBuffer
+{
+public:
+  static constexpr size_t PAGE_SIZE = 0x1000;
+
+  struct MemoryRegion
+  {
+    u8* data;
+    size_t size;
+  };
+
+  explicit RewindBuffer(size_t max_size = 0) : m_max_size(max_size) {}
+
+  // Limits the memory used by the stored snapshots. The oldest snapshots are dropped first;
+  // the most recent one is always kept. 0 means unlimited.
+  void SetMaxSize(size_t max_size);
+  void Clear();
+
+  // section_starts holds the offset of each section after the first one, in ascending order.
+  // The contents of state are taken over, and state is left with the buffer of the previous
+  // snapshot so that the next one can be serialized into it without reallocating.
+  // If the number or the sizes of the regions differ from the previous snapshot's, the older
+  // snapshots are dropped.
+  void Push(std::vector<u8>&& state, const std::vector<size_t>& section_starts = {},
+            const std::vector<MemoryRegion>& regions = {});
+  // Moves the most recent snapshot (and optionally its section starts) out, copies its memory
+  // regions into regions and makes the one before it the most recent. Returns false if the
+  // buffer is empty.
+  bool Pop(std::vector<u8>* state, std::vector<size_t>* section_starts = nullptr,
+           const std::vector<MemoryRegion>& regions = {});
+
+  bool IsEmpty() const { return !m_has_latest; }
+  size_t GetSnapshotCount() const { return m_has_latest ? m_deltas.size() + 1 : 0; }
+  size_t GetMemoryUsage() const { return m_latest.size() + m_regions_size + m_deltas_size; }
+
+private:
+  struct Page
+  {
+    u32 offset;
+    u32 size;
+  };
+
+  struct RegionPage
+  {
+    u32 region;
+    u32 offset;
+    u32 size;
+  };
+
+  // The pages of a snapshot that differ from the snapshot after it. data holds the state pages,
+  // followed by the region pages.
+  struct Delta
+  {
+    size_t state_size;
+    std::vector<size_t> section_starts;
+    std::vector<u64> section_hashes;
+    std::vector<Page> pages;
+    std::vector<RegionPage> region_pages;
+    std::vector<u8> data;
+  };
+
+  struct RegionCopy
+  {
+    std::vector<u8> data;
+    std::vector<u64> page_hashes;
+  };
+
+  static size_t GetSectionStart(const std::vector<size_t>& section_starts, size_t index);
+  static size_t GetSectionEnd(const std::vector<size_t>& section_starts, size_t state_size,
+                              size_t index);
+  static size_t GetDeltaSize(const Delta& delta);
+  bool HasSameRegions(const std::vector<MemoryRegion>& regions) const;
+  void Trim();
+
+  std::vector<u8> m_latest;
+  std::vector<size_t> m_latest_section_starts;
+  std::vector<u64> m_latest_section_hashes;
+  std::vector<RegionCopy> m_regions;
+  size_t m_regions_size = 0;
+  bool m_has_latest = false;
+  // Oldest first.
+  std::deque<Delta> m_deltas;
+  size_t m_deltas_size = 0;
+  size_t m_max_size;
+};
+}  // namespace State
@@ -4,6 +4,10 @@
 
 #include "Core/State.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
 #include <lzo/lzo1x.h>
 #include <map>
 #include <mutex>
@@ -11,8 +15,10 @@
 #include <thread>
 #include <utility>
 #include <vector>
+#include <zlib.h>
 
 #include "Common/ChunkFile.h"
+#include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/File.h"
@@ -21,6 +27,7 @@
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 #include "Common/Version.h"
 
@@ -30,11 +37,14 @@
 #include "Core/CoreTiming.h"
 #include "Core/GeckoCode.h"
 #include "Core/HW/HW.h"
+#include "Core/HW/Memmap.h"
+#include "Core/HW/SystemTimers.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/Movie.h"
 #include "Core/NetPlayClient.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/RewindBuffer.h"
 
 #if defined(HAVE_FFMPEG)
 #include "VideoCommon/AVIDump.h"
@@ -54,12 +64,32 @@ static const u32 IN_LEN = 128 * 1024u;
 
 static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
+// Only used to load states that were saved as a single LZO stream.
 static unsigned char __LZO_MMODEL out[OUT_LEN];
 
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// Compressed states are split into chunks that are compressed independently, so that all
+// of them can be compressed and decompressed at the same time.
+static const u32 CHUNKED_STATE_MAGIC = 0x4B484344;  // "DCHK"
+static const u32 CHUNK_SIZE = 1024 * 1024;
+static const size_t MAX_COMPRESSION_THREADS = 8;
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+enum class ChunkCodec : u32
+{
+  LZO = 0,
+  Zlib = 1,
+};
+
+// Follows the StateHeader of compressed states, and is followed by the compressed size
+// of every chunk (as u32s) and then the chunks themselves.
+struct ChunkedStateHeader
+{
+  u32 magic;
+  u32 codec;
+  u32 chunk_size;
+  u32 num_chunks;
+};
+
+static Common::ThreadPool s_compression_pool;
 
 static std::string g_last_filename;
 
@@ -80,6 +110,13 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 
 static std::thread g_save_thread;
 
+// Only used while the CPU thread is paused, or by the CPU thread itself.
+static RewindBuffer s_rewind_buffer;
+static std::vector<u8> s_rewind_snapshot;
+static std::vector<size_t> s_rewind_sections;
+static u64 s_last_rewind_snapshot_ticks = 0;
+static std::atomic<bool> s_rewind_snapshot_queued{false};
+
 // Don't forget to increase this after doing changes on the savestate system
 static const u32 STATE_VERSION = 92;  // Last changed in PR 6173
 
@@ -153,7 +190,11 @@ static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
   return true;
 }
 
-static std::string DoState(PointerWrap& p)
+// If sections isn't null, the write offset of each subsystem's state gets added to it, so that
+// the rewind buffer can compare the subsystems separately. Rewind snapshots also leave out
+// RAM and EXRAM, which the rewind buffer tracks by itself (see GetRewindMemoryRegions).
+static std::string DoState(PointerWrap& p, std::vector<size_t>* sections = nullptr,
+                           bool include_ram = true)
 {
   std::string version_created_by;
   if (!DoStateVersion(p, &version_created_by))
@@ -178,23 +219,33 @@ static std::string DoState(PointerWrap& p)
     return version_created_by;
   }
 
+  const auto start_section = [&] {
+    if (sections)
+      sections->push_back(p.GetWriteOffset());
+  };
+
   // Begin with video backend, so that it gets a chance to clear its caches and writeback modified
   // things to RAM
   g_video_backend->DoState(p);
   p.DoMarker("video_backend");
 
+  start_section();
   if (SConfig::GetInstance().bWii)
     Wiimote::DoState(p);
   p.DoMarker("Wiimote");
 
+  start_section();
   PowerPC::DoState(p);
   p.DoMarker("PowerPC");
   // CoreTiming needs to be restored before restoring Hardware because
   // the controller code might need to schedule an event if the controller has changed.
+  start_section();
   CoreTiming::DoState(p);
   p.DoMarker("CoreTiming");
-  HW::DoState(p);
+  start_section();
+  HW::DoState(p, include_ram);
   p.DoMarker("HW");
+  start_section();
   Movie::DoState(p);
   p.DoMarker("Movie");
   Gecko::DoState(p);
@@ -225,16 +276,9 @@ void LoadFromBuffer(std::vector<u8>& buffer)
 void SaveToBuffer(std::vector<u8>& buffer)
 {
   Core::RunAsCPUThread([&] {
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-
-    DoState(p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-    buffer.resize(buffer_size);
-
-    ptr = &buffer[0];
-    p.SetMode(PointerWrap::MODE_WRITE);
+    PointerWrap p(&buffer);
     DoState(p);
+    p.FinishWrite();
   });
 }
 
@@ -294,6 +338,132 @@ static std::map<double, int> GetSavedStates()
   return m;
 }
 
+static ChunkCodec GetConfiguredCodec()
+{
+  return !strcasecmp(SConfig::GetInstance().m_strSavestateCodec.c_str(), "zlib") ?
+             ChunkCodec::Zlib :
+             ChunkCodec::LZO;
+}
+
+static bool CompressChunk(ChunkCodec codec, const u8* data, size_t size, std::vector<u8>* output)
+{
+  switch (codec)
+  {
+  case ChunkCodec::Zlib:
+  {
+    uLongf output_size = compressBound(static_cast<uLong>(size));
+    output->resize(output_size);
+    if (compress2(output->data(), &output_size, data, static_cast<uLong>(size), Z_BEST_SPEED) !=
+        Z_OK)
+    {
+      return false;
+    }
+    output->resize(output_size);
+    return true;
+  }
+
+  case ChunkCodec::LZO:
+  {
+    std::vector<lzo_align_t> wrkmem((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) /
+                                    sizeof(lzo_align_t));
+    lzo_uint output_size = 0;
+    output->resize(size + size / 16 + 64 + 3);
+    if (lzo1x_1_compress(data, static_cast<lzo_uint>(size), output->data(), &output_size,
+                         wrkmem.data()) != LZO_E_OK)
+    {
+      return false;
+    }
+    output->resize(output_size);
+    return true;
+  }
+
+  default:
+    return false;
+  }
+}
+
+static bool DecompressChunk(ChunkCodec codec, const u8* data, size_t size, u8* output,
+                            size_t output_size)
+{
+  switch (codec)
+  {
+  case ChunkCodec::Zlib:
+  {
+    uLongf decompressed_size = static_cast<uLongf>(output_size);
+    return uncompress(output, &decompressed_size, data, static_cast<uLong>(size)) == Z_OK &&
+           decompressed_size == output_size;
+  }
+
+  case ChunkCodec::LZO:
+  {
+    lzo_uint decompressed_size = static_cast<lzo_uint>(output_size);
+    return lzo1x_decompress_safe(data, static_cast<lzo_uint>(size), output, &decompressed_size,
+                                 nullptr) == LZO_E_OK &&
+           decompressed_size == output_size;
+  }
+
+  default:
+    return false;
+  }
+}
+
+// Calls task(i) for every chunk index i on the compression pool, or on the calling thread
+// if the pool has no threads. Returns false if any of the tasks failed.
+template <typename F>
+static bool RunChunkTasks(size_t num_chunks, const F& task)
+{
+  bool success = true;
+
+  if (s_compression_pool.GetThreadCount() == 0)
+  {
+    for (size_t i = 0; i < num_chunks; ++i)
+      success &= task(i);
+    return success;
+  }
+
+  std::vector<std::future<bool>> results;
+  results.reserve(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i)
+    results.push_back(s_compression_pool.Schedule([&task, i] { return task(i); }));
+  for (std::future<bool>& result : results)
+    success &= result.get();
+  return success;
+}
+
+static bool ReadChunkedState(File::IOFile& f, const ChunkedStateHeader& chunk_header,
+                             std::vector<u8>& buffer)
+{
+  const ChunkCodec codec = static_cast<ChunkCodec>(chunk_header.codec);
+  const size_t chunk_size = chunk_header.chunk_size;
+  const size_t num_chunks = chunk_header.num_chunks;
+  if (chunk_size == 0 || num_chunks != (buffer.size() + chunk_size - 1) / chunk_size)
+    return false;
+
+  std::vector<u32> compressed_sizes(num_chunks);
+  if (!f.ReadArray(compressed_sizes.data(), num_chunks))
+    return false;
+
+  // The index tells where every chunk starts, so all of them can be read in one go and
+  // decompressed in parallel.
+  std::vector<size_t> offsets(num_chunks);
+  size_t compressed_size = 0;
+  for (size_t i = 0; i < num_chunks; ++i)
+  {
+    offsets[i] = compressed_size;
+    compressed_size += compressed_sizes[i];
+  }
+
+  std::vector<u8> compressed(compressed_size);
+  if (!f.ReadBytes(compressed.data(), compressed_size))
+    return false;
+
+  return RunChunkTasks(num_chunks, [&](size_t i) {
+    const size_t offset = i * chunk_size;
+    return DecompressChunk(codec, &compressed[offsets[i]], compressed_sizes[i], &buffer[offset],
+                           std::min(chunk_size, buffer.size() - offset));
+  });
+}
+
 struct CompressAndDumpState_args
 {
   std::vector<u8>* buffer_vector;
@@ -362,33 +532,33 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
   if (header.size != 0)  // non-zero header size means the state is compressed
   {
-    lzo_uint i = 0;
-    while (true)
+    ChunkedStateHeader chunk_header;
+    chunk_header.magic = CHUNKED_STATE_MAGIC;
+    chunk_header.codec = static_cast<u32>(GetConfiguredCodec());
+    chunk_header.chunk_size = CHUNK_SIZE;
+    chunk_header.num_chunks = static_cast<u32>((buffer_size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+    std::vector<std::vector<u8>> chunks(chunk_header.num_chunks);
+    const bool compressed = RunChunkTasks(chunks.size(), [&](size_t i) {
+      const size_t offset = i * CHUNK_SIZE;
+      return CompressChunk(static_cast<ChunkCodec>(chunk_header.codec), buffer_data + offset,
+                           std::min<size_t>(CHUNK_SIZE, buffer_size - offset), &chunks[i]);
+    });
+    if (!compressed)
     {
-      lzo_uint32 cur_len = 0;
-      lzo_uint out_len = 0;
-
-      if ((i + IN_LEN) >= buffer_size)
-      {
-        cur_len = (lzo_uint32)(buffer_size - i);
-      }
-      else
-      {
-        cur_len = IN_LEN;
-      }
-
-      if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-        PanicAlertT("Internal LZO Error - compression failed");
-
-      // The size of the data to write is 'out_len'
-      f.WriteArray((lzo_uint32*)&out_len, 1);
-      f.WriteBytes(out, out_len);
+      PanicAlertT("Internal Error - savestate compression failed");
+      return;
+    }
 
-      if (cur_len != IN_LEN)
-        break;
+    std::vector<u32> compressed_sizes;
+    compressed_sizes.reserve(chunks.size());
+    for (const std::vector<u8>& chunk : chunks)
+      compressed_sizes.push_back(static_cast<u32>(chunk.size()));
 
-      i += cur_len;
-    }
+    f.WriteArray(&chunk_header, 1);
+    f.WriteArray(compressed_sizes.data(), compressed_sizes.size());
+    for (const std::vector<u8>& chunk : chunks)
+      f.WriteBytes(chunk.data(), chunk.size());
   }
   else  // uncompressed
   {
@@ -402,22 +572,17 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 void SaveAs(const std::string& filename, bool wait)
 {
   Core::RunAsCPUThread([&] {
-    // Measure the size of the buffer.
-    u8* ptr = nullptr;
-    PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-    DoState(p);
-    const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-    // Then actually do the write.
+    // g_current_buffer keeps its capacity between saves, so this usually doesn't allocate.
+    bool success;
     {
       std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-      g_current_buffer.resize(buffer_size);
-      ptr = &g_current_buffer[0];
-      p.SetMode(PointerWrap::MODE_WRITE);
+      PointerWrap p(&g_current_buffer);
       DoState(p);
+      p.FinishWrite();
+      success = p.GetMode() == PointerWrap::MODE_WRITE;
     }
 
-    if (p.GetMode() == PointerWrap::MODE_WRITE)
+    if (success)
     {
       Core::DisplayMessage("Saving State...", 1000);
 
@@ -497,6 +662,23 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
     buffer.resize(header.size);
 
+    ChunkedStateHeader chunk_header;
+    if (f.ReadArray(&chunk_header, 1) && chunk_header.magic == CHUNKED_STATE_MAGIC)
+    {
+      if (!ReadChunkedState(f, chunk_header, buffer))
+      {
+        PanicAlertT("Internal Error - savestate decompression failed\n"
+                    "Try loading the state again");
+        return;
+      }
+      ret_data.swap(buffer);
+      return;
+    }
+
+    // States from older versions are a single stream of LZO blocks.
+    f.Clear();
+    f.Seek(sizeof(StateHeader), SEEK_SET);
+
     lzo_uint i = 0;
     while (true)
     {
@@ -608,6 +790,10 @@ void LoadAs(const std::string& filename)
     {
       if (loadedSuccessfully)
       {
+        // The rewind history belongs to the timeline that was just left.
+        s_rewind_buffer.Clear();
+        s_last_rewind_snapshot_ticks = CoreTiming::GetTicks();
+
         if (ARBruteForcer::ch_bruteforce)
           ARBruteForcer::ch_take_screenshot = 3;
         else
@@ -667,11 +853,15 @@ void Init()
 {
   if (lzo_init() != LZO_E_OK)
     PanicAlertT("Internal LZO Error - lzo_init() failed");
+
+  s_compression_pool.Reset(Common::ThreadPool::GetDefaultThreadCount(MAX_COMPRESSION_THREADS),
+                           "Savestate compression");
 }
 
 void Shutdown()
 {
   Flush();
+  s_compression_pool.Reset(0, "");
 
   // swapping with an empty vector, rather than clear()ing
   // this gives a better guarantee to free the allocated memory right NOW (as opposed to, actually,
@@ -685,6 +875,12 @@ void Shutdown()
     std::lock_guard<std::mutex> lk(g_cs_undo_load_buffer);
     std::vector<u8>().swap(g_undo_load_buffer);
   }
+
+  s_rewind_buffer.Clear();
+  std::vector<u8>().swap(s_rewind_snapshot);
+  s_rewind_sections.clear();
+  s_last_rewind_snapshot_ticks = 0;
+  s_rewind_snapshot_queued = false;
 }
 
 static std::string MakeStateFilename(int number)
@@ -775,4 +971,95 @@ void UndoSaveState()
   LoadAs(File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav");
 }
 
+// RAM and EXRAM are kept out of the rewind snapshots, and the rewind buffer only copies the
+// pages of them that changed.
+static std::vector<RewindBuffer::MemoryRegion> GetRewindMemoryRegions()
+{
+  std::vector<RewindBuffer::MemoryRegion> regions = {{Memory::m_pRAM, Memory::RAM_SIZE}};
+  if (SConfig::GetInstance().bWii)
+    regions.push_back({Memory::m_pEXRAM, Memory::EXRAM_SIZE});
+  return regions;
+}
+
+static void TakeRewindSnapshot()
+{
+  // Like a regular savestate, the snapshot is taken from the host thread, with the CPU thread
+  // stopped between two slices and the GPU thread paused.
+  Core::RunAsCPUThread([] {
+    s_rewind_snapshot_queued = false;
+
+    // The snapshot buffer is reused so that its allocation doesn't have to be redone every second:
+    // Push hands back the buffer of the previous snapshot.
+    s_rewind_sections.clear();
+    PointerWrap p(&s_rewind_snapshot);
+    DoState(p, &s_rewind_sections, false);
+    p.FinishWrite();
+    if (p.GetMode() != PointerWrap::MODE_WRITE)
+      return;
+
+    s_last_rewind_snapshot_ticks = CoreTiming::GetTicks();
+    const int max_size = std::max(SConfig::GetInstance().iRewindBufferSize, 0);
+    s_rewind_buffer.SetMaxSize(static_cast<size_t>(max_size) << 20);
+    s_rewind_buffer.Push(std::move(s_rewind_snapshot), s_rewind_sections,
+                         GetRewindMemoryRegions());
+  });
+}
+
+void RewindUpdate()
+{
+  const SConfig& config = SConfig::GetInstance();
+  if (!config.bEnableRewind || NetPlay::IsNetPlayRunning() || Movie::IsMovieActive() ||
+      ARBruteForcer::ch_bruteforce)
+  {
+    return;
+  }
+
+  const u64 ticks = CoreTiming::GetTicks();
+  if (ticks < s_last_rewind_snapshot_ticks)
+    s_last_rewind_snapshot_ticks = ticks;
+  if (ticks - s_last_rewind_snapshot_ticks < SystemTimers::GetTicksPerSecond())
+    return;
+
+  // VI calls this in the middle of a CoreTiming event, where the state can't be saved: the VI
+  // event isn't scheduled yet and the slice is half done.
+  if (!s_rewind_snapshot_queued.exchange(true))
+    Core::QueueHostJob(TakeRewindSnapshot);
+}
+
+void Rewind()
+{
+  if (!Core::IsRunning())
+  {
+    return;
+  }
+  else if (NetPlay::IsNetPlayRunning())
+  {
+    OSD::AddMessage("Loading savestates is disabled in Netplay to prevent desyncs");
+    return;
+  }
+  else if (Movie::IsMovieActive())
+  {
+    Core::DisplayMessage("Rewinding is disabled while a movie is active", 2000);
+    return;
+  }
+
+  Core::RunAsCPUThread([] {
+    if (!s_rewind_buffer.Pop(&s_rewind_snapshot, nullptr, GetRewindMemoryRegions()))
+    {
+      Core::DisplayMessage("Nothing to rewind to", 2000);
+      return;
+    }
+
+    // Pop has already written RAM and EXRAM back.
+    u8* ptr = s_rewind_snapshot.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    DoState(p, nullptr, false);
+    s_last_rewind_snapshot_ticks = CoreTiming::GetTicks();
+
+    Core::DisplayMessage(StringFromFormat("Rewound (%zu more seconds available)",
+                                          s_rewind_buffer.GetSnapshotCount()),
+                         2000);
+  });
+}
+
 }  // namespace State
@@ -58,6 +58,12 @@ void SaveFirstSaved();
 void UndoSaveState();
 void UndoLoadState();
 
+// Called by VI at the end of every field. Once per emulated second, queues a rewind snapshot to be
+// taken on the host thread.
+void RewindUpdate();
+// Steps back to the most recent rewind snapshot.
+void Rewind();
+
 // wait until previously scheduled savestate event (if any) is done
 void Flush();
 
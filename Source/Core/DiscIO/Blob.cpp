@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cinttypes>
 #include <cstddef>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <string>
@@ -12,6 +14,7 @@
 #include "Common/CDUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/Logging/Log.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
@@ -24,74 +27,144 @@
 
 namespace DiscIO
 {
+// The cache holds as many chunks as fit in this many bytes, and always at least one.
+static constexpr u64 CACHE_SIZE = 4 * 1024 * 1024;
+// Once this many chunks have been read in order, the next GetReadaheadChunks() chunks are read
+// too.
+static constexpr u32 READAHEAD_MIN_SEQUENTIAL_CHUNKS = 2;
+static constexpr u32 READAHEAD_CHUNKS = 4;
+
 void SectorReader::SetSectorSize(int blocksize)
 {
   m_block_size = std::max(blocksize, 0);
-  for (auto& cache_entry : m_cache)
-  {
-    cache_entry.Reset();
-    cache_entry.data.resize(m_chunk_blocks * m_block_size);
-  }
+  ClearCache();
 }
 
 void SectorReader::SetChunkSize(int block_cnt)
 {
   m_chunk_blocks = std::max(block_cnt, 1);
-  // Clear cache and resize the data arrays
-  SetSectorSize(m_block_size);
+  // Clear cache, the lines have the wrong size now
+  ClearCache();
 }
 
 SectorReader::~SectorReader()
 {
+  if (m_cache_stats.hits != 0 || m_cache_stats.misses != 0)
+  {
+    INFO_LOG(DISCIO, "Sector cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                     " chunks read ahead, %" PRIu64 " evictions",
+             m_cache_stats.hits, m_cache_stats.misses, m_cache_stats.readahead_chunks,
+             m_cache_stats.evictions);
+  }
 }
 
-const SectorReader::Cache* SectorReader::FindCacheLine(u64 block_num)
+void SectorReader::ClearCache()
 {
-  auto itr = std::find_if(m_cache.begin(), m_cache.end(),
-                          [&](const Cache& entry) { return entry.Contains(block_num); });
-  if (itr == m_cache.end())
+  m_cache.clear();
+  m_cache_index.clear();
+  m_sequential_chunks = 0;
+}
+
+u32 SectorReader::GetReadaheadChunks() const
+{
+  return READAHEAD_CHUNKS;
+}
+
+u64 SectorReader::GetMaxCacheLines() const
+{
+  const u64 line_size = static_cast<u64>(m_chunk_blocks) * m_block_size;
+  return line_size == 0 ? 1 : std::max<u64>(CACHE_SIZE / line_size, 1);
+}
+
+SectorReader::CacheLine* SectorReader::FindCacheLine(u64 chunk_idx)
+{
+  auto itr = m_cache_index.find(chunk_idx);
+  if (itr == m_cache_index.end())
     return nullptr;
 
-  itr->MarkUsed();
-  return &*itr;
+  // Moving the line to the front keeps the iterators in m_cache_index valid.
+  m_cache.splice(m_cache.begin(), m_cache, itr->second);
+  return &*itr->second;
 }
 
-SectorReader::Cache* SectorReader::GetEmptyCacheLine()
+SectorReader::CacheLine* SectorReader::LoadCacheLine(u64 chunk_idx)
 {
-  Cache* oldest = &m_cache[0];
-  // Find the Least Recently Used cache line to replace.
-  std::for_each(m_cache.begin() + 1, m_cache.end(), [&](Cache& line) {
-    if (line.IsLessRecentlyUsedThan(*oldest))
+  if (m_cache.size() < GetMaxCacheLines())
+  {
+    m_cache.emplace_front();
+    m_cache.front().data.resize(static_cast<size_t>(m_chunk_blocks) * m_block_size);
+  }
+  else
+  {
+    // Evict the least recently used line and reuse its buffer.
+    CacheLine& oldest = m_cache.back();
+    if (oldest.num_blocks != 0)
     {
-      oldest->ShiftLRU();
-      oldest = &line;
-      return;
+      m_cache_index.erase(oldest.block_idx / m_chunk_blocks);
+      ++m_cache_stats.evictions;
     }
-    line.ShiftLRU();
-  });
-  oldest->Reset();
-  return oldest;
+    m_cache.splice(m_cache.begin(), m_cache, std::prev(m_cache.end()));
+  }
+
+  CacheLine& line = m_cache.front();
+  const u32 blocks_read = ReadChunk(line.data.data(), chunk_idx);
+  if (!blocks_read)
+  {
+    // Keep the buffer around for the next load.
+    line.num_blocks = 0;
+    m_cache.splice(m_cache.end(), m_cache, m_cache.begin());
+    return nullptr;
+  }
+
+  line.block_idx = chunk_idx * m_chunk_blocks;
+  line.num_blocks = blocks_read;
+  m_cache_index[chunk_idx] = m_cache.begin();
+  return &line;
 }
 
-const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
+const SectorReader::CacheLine* SectorReader::GetCacheLine(u64 block_num)
 {
-  if (auto entry = FindCacheLine(block_num))
-    return entry;
+  const u64 chunk_idx = block_num / m_chunk_blocks;
+  if (chunk_idx == m_last_chunk_idx + 1)
+    ++m_sequential_chunks;
+  else if (chunk_idx != m_last_chunk_idx)
+    m_sequential_chunks = 0;
+  m_last_chunk_idx = chunk_idx;
+
+  if (CacheLine* line = FindCacheLine(chunk_idx))
+  {
+    ++m_cache_stats.hits;
+    return line->Contains(block_num) ? line : nullptr;
+  }
 
   // Cache miss. Fault in the missing entry.
-  Cache* cache = GetEmptyCacheLine();
-  // We only read aligned chunks, this avoids duplicate overlapping entries.
-  u64 chunk_idx = block_num / m_chunk_blocks;
-  u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
-  if (!blocks_read)
+  ++m_cache_stats.misses;
+  CacheLine* line = LoadCacheLine(chunk_idx);
+  if (!line)
     return nullptr;
-  cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+
+  // Streaming reads would otherwise miss on every chunk. Reading the next chunks now makes
+  // them hit until the reader has caught up, at which point the next batch is read.
+  // The readahead never evicts the line we are about to return.
+  if (m_sequential_chunks >= READAHEAD_MIN_SEQUENTIAL_CHUNKS)
+  {
+    const u64 readahead = std::min<u64>(GetReadaheadChunks(), GetMaxCacheLines() - 1);
+    for (u64 i = 1; i <= readahead; ++i)
+    {
+      if (m_cache_index.count(chunk_idx + i))
+        continue;
+      if (!LoadCacheLine(chunk_idx + i))
+        break;
+      ++m_cache_stats.readahead_chunks;
+    }
+    m_cache.splice(m_cache.begin(), m_cache, m_cache_index[chunk_idx]);
+  }
 
   // Secondary check for out-of-bounds read.
   // If we got less than m_chunk_blocks, we may still have missed.
   // We do this after the cache fill since the cache line itself is
   // fine, the problem is being asked to read past the end of the disk.
-  return cache->Contains(block_num) ? cache : nullptr;
+  return line->Contains(block_num) ? line : nullptr;
 }
 
 bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
@@ -104,7 +177,7 @@ bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
   {
     block = offset / m_block_size;
 
-    const Cache* cache = GetCacheLine(block);
+    const CacheLine* cache = GetCacheLine(block);
     if (!cache)
       return false;
 
@@ -15,9 +15,11 @@
 // automatically do the right thing.
 
 #include <array>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -76,6 +78,15 @@ public:
 
   bool Read(u64 offset, u64 size, u8* out_ptr) override;
 
+  struct CacheStats
+  {
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 readahead_chunks = 0;
+    u64 evictions = 0;
+  };
+  const CacheStats& GetCacheStats() const { return m_cache_stats; }
+
 protected:
   void SetSectorSize(int blocksize);
   int GetSectorSize() const { return m_block_size; }
@@ -86,6 +97,10 @@ protected:
   // as large reads are slow and will take too long to resolve.
   void SetChunkSize(int blocks);
   int GetChunkSize() const { return m_chunk_blocks; }
+  // The number of chunks that are read right away once sequential access is detected.
+  // Readers that read ahead on their own return 0, so that the reading thread doesn't wait for
+  // the blocks they are still working on.
+  virtual u32 GetReadaheadChunks() const;
   // Read a single block/sector.
   virtual bool GetBlock(u64 block_num, u8* out) = 0;
 
@@ -95,52 +110,31 @@ protected:
   virtual bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr);
 
 private:
-  struct Cache
+  struct CacheLine
   {
     std::vector<u8> data;
     u64 block_idx = 0;
     u32 num_blocks = 0;
 
-    // [Pseudo-] Least Recently Used Shift Register
-    // When an empty cache line is needed, the line with the lowest value
-    // is taken and reset; the LRU register is then shifted down 1 place
-    // on all lines (low bit discarded). When a line is used, the high bit
-    // is set marking it as most recently used.
-    u32 lru_sreg = 0;
-
-    void Reset()
-    {
-      block_idx = 0;
-      num_blocks = 0;
-      lru_sreg = 0;
-    }
-    void Fill(u64 block, u32 count)
-    {
-      block_idx = block;
-      num_blocks = count;
-      // NOTE: Setting only the high bit means the newest line will
-      //   be selected for eviction if every line in the cache was
-      //   touched. This gives MRU behavior which is probably
-      //   desirable in that case.
-      MarkUsed();
-    }
     bool Contains(u64 block) const { return block >= block_idx && block - block_idx < num_blocks; }
-    void MarkUsed() { lru_sreg |= 0x80000000; }
-    void ShiftLRU() { lru_sreg >>= 1; }
-    bool IsLessRecentlyUsedThan(const Cache& other) const { return lru_sreg < other.lru_sreg; }
   };
 
-  // Gets the cache line that contains the given block, or nullptr.
-  // NOTE: The cache record only lasts until it expires (next GetEmptyCacheLine)
-  const Cache* FindCacheLine(u64 block_num);
+  // Most recently used first.
+  using CacheList = std::list<CacheLine>;
 
-  // Finds the least recently used cache line, resets and returns it.
-  Cache* GetEmptyCacheLine();
+  void ClearCache();
+  u64 GetMaxCacheLines() const;
 
-  // Combines FindCacheLine with GetEmptyCacheLine and ReadChunk.
-  // Always returns a valid cache line (loading the data if needed).
+  // Gets the cache line of the given chunk, or nullptr. Marks it as most recently used.
+  CacheLine* FindCacheLine(u64 chunk_idx);
+
+  // Reads a chunk into the least recently used cache line (or a new one) and makes it the
+  // most recently used line. Returns nullptr if the read fails.
+  CacheLine* LoadCacheLine(u64 chunk_idx);
+
+  // Combines FindCacheLine with LoadCacheLine and the readahead policy.
   // May return nullptr only if the cache missed and the read failed.
-  const Cache* GetCacheLine(u64 block_num);
+  const CacheLine* GetCacheLine(u64 block_num);
 
   // Read all bytes from a chunk of blocks into a buffer.
   // Returns the number of blocks read (may be less than m_chunk_blocks
@@ -148,14 +142,14 @@ private:
   // evenly divisible into chunks). Returns zero if it fails.
   u32 ReadChunk(u8* buffer, u64 chunk_num);
 
-#if defined(_MSC_VER) && _MSC_VER <= 1800
-#define CACHE_LINES 32
-#else
-	static constexpr int CACHE_LINES = 32;
-#endif
-	u32 m_block_size   = 0;  // Bytes in a sector/block
-	u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
-	std::array<Cache, CACHE_LINES> m_cache;
+  u32 m_block_size = 0;    // Bytes in a sector/block
+  u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
+
+  CacheList m_cache;
+  std::unordered_map<u64, CacheList::iterator> m_cache_index;  // Keyed by chunk index
+  u64 m_last_chunk_idx = 0;
+  u32 m_sequential_chunks = 0;
+  CacheStats m_cache_stats;
 };
 
 // Factory function - examines the path to choose the right type of BlobReader, and returns one.
@@ -8,9 +8,11 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
+#include <future>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,12 +26,21 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
 
 namespace DiscIO
 {
+static constexpr size_t MAX_PREFETCH_THREADS = 4;
+static constexpr size_t PREFETCH_BLOCKS_PER_THREAD = 4;
+static constexpr u32 PREFETCH_MIN_SEQUENTIAL_BLOCKS = 2;
+
+static constexpr size_t MAX_COMPRESSION_THREADS = 16;
+static constexpr size_t COMPRESSION_TASKS_PER_THREAD = 2;
+static constexpr u32 BLOCKS_PER_COMPRESSION_TASK = 8;
+
 bool IsGCZBlob(File::IOFile& file);
 
 CompressedBlobReader::CompressedBlobReader(File::IOFile file, const std::string& filename)
@@ -85,72 +96,215 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
   return 0;
 }
 
-bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+u32 CompressedBlobReader::ReadRawBlock(u64 block_num, u8* buffer)
 {
-  bool uncompressed = false;
-  u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
-  u64 offset = m_block_pointers[block_num] + m_data_offset;
-
-  if (offset & (1ULL << 63))
-  {
-    if (comp_block_size != m_header.block_size)
-      NOTICE_LOG(DISCIO, "Uncompressed block with wrong size");
-    uncompressed = true;
-    offset &= ~(1ULL << 63);
-  }
+  const u32 comp_block_size = static_cast<u32>(GetBlockCompressedSize(block_num));
+  const u64 offset = (m_block_pointers[block_num] + m_data_offset) & ~(1ULL << 63);
 
   // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
-  memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
+  std::fill(buffer + comp_block_size, buffer + m_zlib_buffer.size(), 0);
 
   m_file.Seek(offset, SEEK_SET);
-  if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+  if (!m_file.ReadBytes(buffer, comp_block_size))
   {
     NOTICE_LOG(DISCIO, "The disc image \"%s\" is truncated, some of the data is missing.",
-                m_file_name.c_str());
+               m_file_name.c_str());
     m_file.Clear();
-    return false;
+    return 0;
   }
 
+  return comp_block_size;
+}
+
+bool CompressedBlobReader::DecodeBlock(u64 block_num, const u8* raw_data, u32 raw_size,
+                                       u8* out_ptr) const
+{
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(raw_data, raw_size);
   if (block_hash != m_hashes[block_num])
     NOTICE_LOG(DISCIO, "The disc image \"%s\" is corrupt.\n"
-                "Hash of block %" PRIu64 " is %08x instead of %08x.",
-                m_file_name.c_str(),
-                block_num, block_hash, m_hashes[block_num]);
-
-	if (uncompressed)
-	{
-		std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
-	}
-	else
-	{
-		z_stream z = {};
-		z.next_in  = m_zlib_buffer.data();
-		z.avail_in = comp_block_size;
-		if (z.avail_in > m_header.block_size)
-		{
-			NOTICE_LOG(DISCIO, "We have a problem");
-		}
-		z.next_out  = out_ptr;
-		z.avail_out = m_header.block_size;
-		inflateInit(&z);
-		int status = inflate(&z, Z_FULL_FLUSH);
-		u32 uncomp_size = m_header.block_size - z.avail_out;
-		if (status != Z_STREAM_END)
-		{
-			// this seem to fire wrongly from time to time
-			// to be sure, don't use compressed isos :P
-			NOTICE_LOG(DISCIO, "Failure reading block %" PRIu64 " - out of data and not at end.", block_num);
-		}
-		inflateEnd(&z);
-		if (uncomp_size != m_header.block_size)
-		{
-			NOTICE_LOG(DISCIO, "Wrong block size");
-			return false;
-		}
-	}
-	return true;
+                       "Hash of block %" PRIu64 " is %08x instead of %08x.",
+               m_file_name.c_str(), block_num, block_hash, m_hashes[block_num]);
+
+  if (m_block_pointers[block_num] & (1ULL << 63))
+  {
+    if (raw_size != m_header.block_size)
+      NOTICE_LOG(DISCIO, "Uncompressed block with wrong size");
+    std::copy(raw_data, raw_data + raw_size, out_ptr);
+    return true;
+  }
+
+  z_stream z = {};
+  z.next_in = const_cast<u8*>(raw_data);
+  z.avail_in = raw_size;
+  if (z.avail_in > m_header.block_size)
+  {
+    NOTICE_LOG(DISCIO, "We have a problem");
+  }
+  z.next_out = out_ptr;
+  z.avail_out = m_header.block_size;
+  inflateInit(&z);
+  int status = inflate(&z, Z_FULL_FLUSH);
+  u32 uncomp_size = m_header.block_size - z.avail_out;
+  if (status != Z_STREAM_END)
+  {
+    // this seem to fire wrongly from time to time
+    // to be sure, don't use compressed isos :P
+    NOTICE_LOG(DISCIO, "Failure reading block %" PRIu64 " - out of data and not at end.",
+               block_num);
+  }
+  inflateEnd(&z);
+  if (uncomp_size != m_header.block_size)
+  {
+    NOTICE_LOG(DISCIO, "Wrong block size");
+    return false;
+  }
+  return true;
+}
+
+void CompressedBlobReader::InitPrefetch()
+{
+  m_prefetch_initialized = true;
+
+  const size_t num_threads = Common::ThreadPool::GetDefaultThreadCount(MAX_PREFETCH_THREADS);
+  if (num_threads == 0)
+    return;
+
+  m_prefetch_pool.Reset(num_threads, "GCZ Prefetch");
+  m_prefetch.resize(num_threads * PREFETCH_BLOCKS_PER_THREAD);
+  for (PrefetchedBlock& prefetched : m_prefetch)
+    prefetched.buffers = CreatePrefetchBuffers();
+}
+
+std::shared_ptr<CompressedBlobReader::PrefetchBuffers>
+CompressedBlobReader::CreatePrefetchBuffers() const
+{
+  auto buffers = std::make_shared<PrefetchBuffers>();
+  buffers->raw_data.resize(m_zlib_buffer.size());
+  buffers->data.resize(m_header.block_size);
+  return buffers;
+}
+
+void CompressedBlobReader::PrefetchBlock(u64 block_num)
+{
+  if (block_num >= m_header.num_blocks)
+    return;
+
+  PrefetchedBlock& prefetched = m_prefetch[block_num % m_prefetch.size()];
+  if (prefetched.scheduled)
+  {
+    if (prefetched.block_num == block_num)
+      return;
+
+    // The slot still holds a block that the reader skipped. Rather than waiting for it, leave
+    // its buffers to the task and let it finish in the background.
+    if (prefetched.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      prefetched.buffers = CreatePrefetchBuffers();
+    prefetched.scheduled = false;
+  }
+
+  // The file is only accessed from this thread, the workers just decompress.
+  const u32 raw_size = ReadRawBlock(block_num, prefetched.buffers->raw_data.data());
+  if (raw_size == 0)
+    return;
+
+  prefetched.block_num = block_num;
+  prefetched.scheduled = true;
+  const std::shared_ptr<PrefetchBuffers> buffers = prefetched.buffers;
+  prefetched.result = m_prefetch_pool.Schedule([this, buffers, block_num, raw_size] {
+    return DecodeBlock(block_num, buffers->raw_data.data(), raw_size, buffers->data.data());
+  });
+}
+
+bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+{
+  bool success;
+  PrefetchedBlock* prefetched =
+      m_prefetch.empty() ? nullptr : &m_prefetch[block_num % m_prefetch.size()];
+  if (prefetched && prefetched->scheduled && prefetched->block_num == block_num)
+  {
+    prefetched->scheduled = false;
+    success = prefetched->result.get();
+    if (success)
+      std::copy(prefetched->buffers->data.begin(), prefetched->buffers->data.end(), out_ptr);
+  }
+  else
+  {
+    const u32 raw_size = ReadRawBlock(block_num, m_zlib_buffer.data());
+    success = raw_size != 0 && DecodeBlock(block_num, m_zlib_buffer.data(), raw_size, out_ptr);
+  }
+
+  // Random accesses shouldn't make the workers decompress blocks that are never read,
+  // so only start reading ahead after a few sequential blocks.
+  m_sequential_blocks = block_num == m_last_block_num + 1 ? m_sequential_blocks + 1 : 0;
+  m_last_block_num = block_num;
+  if (m_sequential_blocks >= PREFETCH_MIN_SEQUENTIAL_BLOCKS)
+  {
+    // Most readers are only opened to get some metadata, e.g. for the game list, so the worker
+    // threads are only started once they are needed.
+    if (!m_prefetch_initialized)
+      InitPrefetch();
+
+    for (u64 i = 1; i <= m_prefetch.size(); ++i)
+      PrefetchBlock(block_num + i);
+  }
+
+  return success;
+}
+
+namespace
+{
+struct CompressionBlock
+{
+  std::vector<u8> in_buf;
+  std::vector<u8> out_buf;
+  // Points to in_buf or out_buf, depending on whether the block got compressed.
+  const u8* write_buf = nullptr;
+  u32 write_size = 0;
+};
+}
+
+// Compresses count blocks with one z_stream. Runs on the worker threads of CompressFileToBlob.
+static bool CompressBlocks(CompressionBlock* blocks, size_t count, u32 block_size)
+{
+  z_stream z = {};
+  if (deflateInit(&z, 9) != Z_OK)
+    return false;
+
+  bool success = true;
+  for (size_t i = 0; i < count; ++i)
+  {
+    CompressionBlock& block = blocks[i];
+
+    if (deflateReset(&z) != Z_OK)
+    {
+      success = false;
+      break;
+    }
+    z.next_in = block.in_buf.data();
+    z.avail_in = block_size;
+    z.next_out = block.out_buf.data();
+    z.avail_out = block_size;
+
+    int status = deflate(&z, Z_FINISH);
+    int comp_size = block_size - z.avail_out;
+
+    if ((status != Z_STREAM_END) || (z.avail_out < 10))
+    {
+      // let's store uncompressed
+      block.write_buf = block.in_buf.data();
+      block.write_size = block_size;
+    }
+    else
+    {
+      // let's store compressed
+      block.write_buf = block.out_buf.data();
+      block.write_size = comp_size;
+    }
+  }
+
+  deflateEnd(&z);
+  return success;
 }
 
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
@@ -194,9 +348,17 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
+  // Blocks are compressed independently of each other, so batches of them are spread over
+  // worker threads. Reading and writing stay on this thread, in order.
+  Common::ThreadPool pool(Common::ThreadPool::GetDefaultThreadCount(MAX_COMPRESSION_THREADS),
+                          "GCZ Compression");
+  std::vector<CompressionBlock> blocks(std::max<size_t>(1, pool.GetThreadCount()) *
+                                       COMPRESSION_TASKS_PER_THREAD * BLOCKS_PER_COMPRESSION_TASK);
+  for (CompressionBlock& block : blocks)
+  {
+    block.in_buf.resize(block_size);
+    block.out_buf.resize(block_size);
+  }
 
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
@@ -211,8 +373,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -228,84 +388,98 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   bool success = true;
 
-  for (u32 i = 0; i < header.num_blocks; i++)
+  for (u32 batch_start = 0; success && batch_start < header.num_blocks;
+       batch_start += static_cast<u32>(blocks.size()))
   {
-    if (i % progress_monitor == 0)
-    {
-      const u64 inpos = infile.Tell();
-      int ratio = 0;
-      if (inpos != 0)
-        ratio = (int)(100 * position / inpos);
-
-      std::string temp =
-          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-                           header.num_blocks, ratio);
-      bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-      if (was_cancelled)
-      {
-        success = false;
-        break;
-      }
-    }
+    const u32 batch_size =
+        std::min(static_cast<u32>(blocks.size()), header.num_blocks - batch_start);
 
-    offsets[i] = position;
-
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
+    for (u32 j = 0; j < batch_size; j++)
     {
-      ERROR_LOG(DISCIO, "Deflate failed");
-      success = false;
-      break;
+      std::vector<u8>& in_buf = blocks[j].in_buf;
+      size_t read_bytes;
+      if (scrubbing)
+        read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
+      else
+        infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
+      if (read_bytes < header.block_size)
+        std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
     }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
-
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
+    bool compressed = true;
+    if (pool.GetThreadCount() == 0)
     {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
+      compressed = CompressBlocks(blocks.data(), batch_size, header.block_size);
     }
     else
     {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
+      std::vector<std::future<bool>> results;
+      for (u32 j = 0; j < batch_size; j += BLOCKS_PER_COMPRESSION_TASK)
+      {
+        const u32 count = std::min<u32>(BLOCKS_PER_COMPRESSION_TASK, batch_size - j);
+        CompressionBlock* task_blocks = &blocks[j];
+        const u32 task_block_size = header.block_size;
+        results.push_back(pool.Schedule([task_blocks, count, task_block_size] {
+          return CompressBlocks(task_blocks, count, task_block_size);
+        }));
+      }
+      for (std::future<bool>& result : results)
+        compressed &= result.get();
     }
 
-    if (!outfile.WriteBytes(write_buf, write_size))
+    if (!compressed)
     {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
+      ERROR_LOG(DISCIO, "Deflate failed");
       success = false;
       break;
     }
 
-    position += write_size;
+    for (u32 j = 0; j < batch_size; j++)
+    {
+      const u32 i = batch_start + j;
+      if (i % progress_monitor == 0)
+      {
+        const u64 inpos = static_cast<u64>(i) * header.block_size;
+        int ratio = 0;
+        if (inpos != 0)
+          ratio = (int)(100 * position / inpos);
+
+        std::string temp =
+            StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
+                             header.num_blocks, ratio);
+        bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
+        if (was_cancelled)
+        {
+          success = false;
+          break;
+        }
+      }
 
-    hashes[i] = HashAdler32(write_buf, write_size);
+      const CompressionBlock& block = blocks[j];
+      offsets[i] = position;
+      if (block.write_buf == block.in_buf.data())
+      {
+        offsets[i] |= 0x8000000000000000ULL;
+        num_stored++;
+      }
+      else
+      {
+        num_compressed++;
+      }
+
+      if (!outfile.WriteBytes(block.write_buf, block.write_size))
+      {
+        PanicAlertT("Failed to write the output file \"%s\".\n"
+                    "Check that you have enough space available on the target drive.",
+                    outfile_path.c_str());
+        success = false;
+        break;
+      }
+
+      position += block.write_size;
+
+      hashes[i] = HashAdler32(block.write_buf, block.write_size);
+    }
   }
 
   header.compressed_data_size = position;
@@ -325,9 +499,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
@@ -13,12 +13,14 @@
 
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -54,9 +56,39 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+protected:
+  // GetBlock decompresses the following blocks on worker threads.
+  u32 GetReadaheadChunks() const override { return 0; }
+
 private:
   CompressedBlobReader(File::IOFile file, const std::string& filename);
 
+  struct PrefetchBuffers
+  {
+    std::vector<u8> raw_data;
+    std::vector<u8> data;
+  };
+
+  // A block that is being decompressed ahead of time by m_prefetch_pool. The task shares the
+  // buffers, so that a slot can be reused for another block without waiting for the task.
+  struct PrefetchedBlock
+  {
+    u64 block_num = 0;
+    bool scheduled = false;
+    std::shared_ptr<PrefetchBuffers> buffers;
+    std::future<bool> result;
+  };
+
+  // Reads the stored data of a block into buffer, which must be m_zlib_buffer.size() bytes long.
+  // Returns the number of bytes read, or 0 on failure.
+  u32 ReadRawBlock(u64 block_num, u8* buffer);
+  // Checks the hash of the stored data and decompresses it if needed. Only reads constant
+  // state, so it can run on any thread.
+  bool DecodeBlock(u64 block_num, const u8* raw_data, u32 raw_size, u8* out_ptr) const;
+  void InitPrefetch();
+  std::shared_ptr<PrefetchBuffers> CreatePrefetchBuffers() const;
+  void PrefetchBlock(u64 block_num);
+
   CompressedBlobHeader m_header;
   std::vector<u64> m_block_pointers;
   std::vector<u32> m_hashes;
@@ -65,6 +97,15 @@ private:
   u64 m_file_size;
   std::vector<u8> m_zlib_buffer;
   std::string m_file_name;
+
+  // Sequential reads (streaming, level loads) are detected by GetBlock and the blocks after
+  // them get decompressed on worker threads, one slot per block ahead (indexed by block % size).
+  std::vector<PrefetchedBlock> m_prefetch;
+  bool m_prefetch_initialized = false;
+  u64 m_last_block_num = 0;
+  u32 m_sequential_blocks = 0;
+  // Declared last so that it is destroyed (and its threads joined) first.
+  Common::ThreadPool m_prefetch_pool;
 };
 
 }  // namespace
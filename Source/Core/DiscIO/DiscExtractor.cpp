@@ -10,10 +10,13 @@
 #include <optional>
 
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
+#include "DiscIO/WiiPartitionScanner.h"
 
 namespace DiscIO
 {
@@ -339,6 +342,30 @@ bool ExportFST(const Volume& volume, const Partition& partition, const std::stri
   return ExportData(volume, partition, *fst_offset, *fst_size, export_filename);
 }
 
+bool ExportDecryptedPartition(const Volume& volume, const Partition& partition,
+                              const std::string& export_filename)
+{
+  if (volume.GetVolumeType() != Platform::WII_DISC)
+    return false;
+
+  File::IOFile f(export_filename, "wb");
+  if (!f)
+    return false;
+
+  const WiiPartitionScanResult result =
+      ScanWiiPartition(volume, partition, [&f](u64 offset, const u8* data, size_t size) {
+        return f.WriteBytes(data, size);
+      });
+  if (!result.IsValid() && !result.read_error && !result.cancelled)
+  {
+    WARN_LOG(DISCIO, "Exported partition has %" PRIu64 " clusters and %" PRIu64
+                     " groups with invalid hashes",
+             result.bad_clusters, result.bad_groups);
+  }
+
+  return !result.read_error && !result.cancelled;
+}
+
 bool ExportSystemData(const Volume& volume, const Partition& partition,
                       const std::string& export_folder)
 {
@@ -65,6 +65,11 @@ std::optional<u64> GetFSTSize(const Volume& volume, const Partition& partition);
 bool ExportFST(const Volume& volume, const Partition& partition,
                const std::string& export_filename);
 
+// Writes the decrypted data of the whole partition, as seen by Volume::Read. The hashes get
+// checked along the way, but a partition with bad hashes is still exported.
+bool ExportDecryptedPartition(const Volume& volume, const Partition& partition,
+                              const std::string& export_filename);
+
 bool ExportSystemData(const Volume& volume, const Partition& partition,
                       const std::string& export_folder);
 
@@ -6,11 +6,11 @@
 
 #include <algorithm>
 #include <array>
+#include <cinttypes>
 #include <cstddef>
 #include <cstring>
 #include <map>
 #include <mbedtls/aes.h>
-#include <mbedtls/sha1.h>
 #include <memory>
 #include <optional>
 #include <string>
@@ -22,6 +22,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
+#include "Common/ThreadPool.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/DiscExtractor.h"
@@ -29,18 +30,35 @@
 #include "DiscIO/FileSystemGCWii.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
+#include "DiscIO/WiiPartitionScanner.h"
 #include "DiscIO/WiiSaveBanner.h"
 
 namespace DiscIO
 {
 constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
 
+// Once a few blocks have been read in order, the next ones are decrypted on worker threads.
+constexpr u32 PREFETCH_MIN_SEQUENTIAL_BLOCKS = 2;
+constexpr u64 PREFETCH_BLOCKS = 4;
+constexpr size_t MAX_DECRYPTION_THREADS = 2;
+
+// Decrypts the data of an encrypted block. The IV at 0x3D0 - 0x3DF gets overwritten.
+static void DecryptBlockData(mbedtls_aes_context* aes_context, u8* encrypted_block, u8* out_ptr)
+{
+  mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, VolumeWii::BLOCK_DATA_SIZE,
+                        &encrypted_block[0x3D0], &encrypted_block[VolumeWii::BLOCK_HEADER_SIZE],
+                        out_ptr);
+}
+
 VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
-    : m_pReader(std::move(reader)), m_game_partition(PARTITION_NONE),
-      m_last_decrypted_block(UINT64_MAX)
+    : m_pReader(std::move(reader)), m_game_partition(PARTITION_NONE)
 {
   _assert_(m_pReader);
 
+  m_read_buffer.resize(BLOCK_TOTAL_SIZE);
+  for (DecryptedBlock& block : m_decrypted_blocks)
+    block.data.resize(BLOCK_DATA_SIZE);
+
   if (m_pReader->ReadSwapped<u32>(0x60) != u32(0))
   {
     // No partitions - just read unencrypted data like with a GC disc
@@ -118,12 +136,22 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
         return file_system->IsValid() ? std::move(file_system) : nullptr;
       };
 
+      auto get_data_end = [this, partition]() -> u64 {
+        const std::optional<u64> data_offset =
+            ReadSwappedAndShifted(partition.offset + 0x2b8, PARTITION_NONE);
+        const std::optional<u64> data_size =
+            ReadSwappedAndShifted(partition.offset + 0x2bc, PARTITION_NONE);
+        if (!data_offset || !data_size)
+          return 0;
+        return partition.offset + *data_offset + *data_size;
+      };
+
       m_partitions.emplace(
           partition, PartitionDetails{Common::Lazy<std::unique_ptr<mbedtls_aes_context>>(get_key),
                                       Common::Lazy<IOS::ES::TicketReader>(get_ticket),
                                       Common::Lazy<IOS::ES::TMDReader>(get_tmd),
                                       Common::Lazy<std::unique_ptr<FileSystem>>(get_file_system),
-                                      *partition_type});
+                                      Common::Lazy<u64>(get_data_end), *partition_type});
     }
   }
 }
@@ -148,7 +176,6 @@ bool VolumeWii::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, const Partition
   if (!aes_context)
     return false;
 
-  std::vector<u8> read_buffer(BLOCK_TOTAL_SIZE);
   while (_Length > 0)
   {
     // Calculate offsets
@@ -156,30 +183,14 @@ bool VolumeWii::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, const Partition
         partition.offset + PARTITION_DATA_OFFSET + _ReadOffset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
     u64 data_offset_in_block = _ReadOffset % BLOCK_DATA_SIZE;
 
-    if (m_last_decrypted_block != block_offset_on_disc)
-    {
-      // Read the current block
-      if (!m_pReader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, read_buffer.data()))
-        return false;
-
-      // Decrypt the block's data.
-      // 0x3D0 - 0x3DF in read_buffer will be overwritten,
-      // but that won't affect anything, because we won't
-      // use the content of read_buffer anymore after this
-      mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, &read_buffer[0x3D0],
-                            &read_buffer[BLOCK_HEADER_SIZE], m_last_decrypted_block_data);
-      m_last_decrypted_block = block_offset_on_disc;
-
-      // The only thing we currently use from the 0x000 - 0x3FF part
-      // of the block is the IV (at 0x3D0), but it also contains SHA-1
-      // hashes that IOS uses to check that discs aren't tampered with.
-      // http://wiibrew.org/wiki/Wii_Disc#Encrypted
-    }
+    const DecryptedBlock* block =
+        GetDecryptedBlock(block_offset_on_disc, aes_context, *it->second.data_end);
+    if (!block)
+      return false;
 
     // Copy the decrypted data
     u64 copy_size = std::min(_Length, BLOCK_DATA_SIZE - data_offset_in_block);
-    memcpy(_pBuffer, &m_last_decrypted_block_data[data_offset_in_block],
-           static_cast<size_t>(copy_size));
+    memcpy(_pBuffer, &block->data[data_offset_in_block], static_cast<size_t>(copy_size));
 
     // Update offsets
     _Length -= copy_size;
@@ -190,6 +201,118 @@ bool VolumeWii::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, const Partition
   return true;
 }
 
+const VolumeWii::DecryptedBlock* VolumeWii::GetDecryptedBlock(u64 block_offset_on_disc,
+                                                              mbedtls_aes_context* aes_context,
+                                                              u64 partition_data_end) const
+{
+  DecryptedBlock* block = FindDecryptedBlock(block_offset_on_disc);
+  if (block)
+  {
+    if (block->pending.valid())
+      block->pending.get();
+  }
+  else
+  {
+    block = &GetLeastRecentlyUsedBlock();
+    block->offset_on_disc = UINT64_MAX;
+
+    // Read the current block
+    if (!m_pReader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, m_read_buffer.data()))
+      return nullptr;
+
+    // The only thing we currently use from the 0x000 - 0x3FF part
+    // of the block is the IV (at 0x3D0), but it also contains SHA-1
+    // hashes that IOS uses to check that discs aren't tampered with.
+    // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+    DecryptBlockData(aes_context, m_read_buffer.data(), block->data.data());
+    block->offset_on_disc = block_offset_on_disc;
+  }
+  block->last_used = ++m_decrypted_block_tick;
+
+  if (block_offset_on_disc == m_last_block_offset_on_disc + BLOCK_TOTAL_SIZE)
+    ++m_sequential_blocks;
+  else if (block_offset_on_disc != m_last_block_offset_on_disc)
+    m_sequential_blocks = 0;
+  m_last_block_offset_on_disc = block_offset_on_disc;
+
+  // The prefetched blocks are used more recently than the block we return,
+  // but there are enough cache entries that it can't be the one that gets evicted.
+  static_assert(PREFETCH_BLOCKS < DECRYPTED_BLOCK_CACHE_SIZE,
+                "Prefetch would evict blocks in use");
+  if (m_sequential_blocks >= PREFETCH_MIN_SEQUENTIAL_BLOCKS)
+  {
+    // Volumes that are only opened for their metadata never start the threads.
+    if (!m_decryption_pool_initialized)
+      InitDecryptionPool();
+
+    if (m_decryption_pool.GetThreadCount() != 0)
+    {
+      for (u64 i = 1; i <= PREFETCH_BLOCKS; ++i)
+      {
+        PrefetchBlock(block_offset_on_disc + i * BLOCK_TOTAL_SIZE, aes_context,
+                      partition_data_end);
+      }
+    }
+  }
+
+  return block;
+}
+
+VolumeWii::DecryptedBlock* VolumeWii::FindDecryptedBlock(u64 block_offset_on_disc) const
+{
+  auto it = std::find_if(m_decrypted_blocks.begin(), m_decrypted_blocks.end(),
+                         [block_offset_on_disc](const DecryptedBlock& block) {
+                           return block.offset_on_disc == block_offset_on_disc;
+                         });
+  return it != m_decrypted_blocks.end() ? &*it : nullptr;
+}
+
+VolumeWii::DecryptedBlock& VolumeWii::GetLeastRecentlyUsedBlock() const
+{
+  DecryptedBlock& block = *std::min_element(
+      m_decrypted_blocks.begin(), m_decrypted_blocks.end(),
+      [](const DecryptedBlock& a, const DecryptedBlock& b) { return a.last_used < b.last_used; });
+
+  // A worker may still be writing to the buffers.
+  if (block.pending.valid())
+    block.pending.get();
+  return block;
+}
+
+void VolumeWii::InitDecryptionPool() const
+{
+  m_decryption_pool_initialized = true;
+
+  const size_t num_threads = Common::ThreadPool::GetDefaultThreadCount(MAX_DECRYPTION_THREADS);
+  if (num_threads != 0)
+    m_decryption_pool.Reset(num_threads, "Wii Decryption");
+}
+
+void VolumeWii::PrefetchBlock(u64 block_offset_on_disc, mbedtls_aes_context* aes_context,
+                              u64 partition_data_end) const
+{
+  // Don't decrypt whatever comes after the end of the partition.
+  if (block_offset_on_disc + BLOCK_TOTAL_SIZE > partition_data_end ||
+      block_offset_on_disc + BLOCK_TOTAL_SIZE > m_pReader->GetDataSize() ||
+      FindDecryptedBlock(block_offset_on_disc))
+  {
+    return;
+  }
+
+  DecryptedBlock& block = GetLeastRecentlyUsedBlock();
+  block.offset_on_disc = UINT64_MAX;
+  block.encrypted_data.resize(BLOCK_TOTAL_SIZE);
+  // The blob reader is only used on this thread, the workers just decrypt.
+  if (!m_pReader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, block.encrypted_data.data()))
+    return;
+
+  block.offset_on_disc = block_offset_on_disc;
+  block.last_used = ++m_decrypted_block_tick;
+  block.pending = m_decryption_pool.Schedule([aes_context, &block] {
+    DecryptBlockData(aes_context, block.encrypted_data.data(), block.data.data());
+  });
+}
+
 std::vector<Partition> VolumeWii::GetPartitions() const
 {
   std::vector<Partition> partitions;
@@ -357,75 +480,25 @@ u64 VolumeWii::GetRawSize() const
 
 bool VolumeWii::CheckIntegrity(const Partition& partition) const
 {
-  // Get the decryption key for the partition
-  auto it = m_partitions.find(partition);
-  if (it == m_partitions.end())
+  if (m_partitions.find(partition) == m_partitions.end())
     return false;
-  mbedtls_aes_context* aes_context = it->second.key->get();
-  if (!aes_context)
-    return false;
-
-  // Get partition data size
-  u32 partSizeDiv4;
-  m_pReader->Read(partition.offset + 0x2BC, 4, (u8*)&partSizeDiv4);
-  u64 partDataSize = (u64)Common::swap32(partSizeDiv4) * 4;
 
-  u32 nClusters = (u32)(partDataSize / 0x8000);
-  for (u32 clusterID = 0; clusterID < nClusters; ++clusterID)
+  const WiiPartitionScanResult result = ScanWiiPartition(*this, partition);
+  if (result.read_error)
   {
-    u64 clusterOff = partition.offset + PARTITION_DATA_OFFSET + (u64)clusterID * 0x8000;
-
-    // Read and decrypt the cluster metadata
-    u8 clusterMDCrypted[0x400];
-    u8 clusterMD[0x400];
-    u8 IV[16] = {0};
-    if (!m_pReader->Read(clusterOff, 0x400, clusterMDCrypted))
-    {
-      WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: could not read metadata", clusterID);
-      return false;
-    }
-    mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, 0x400, IV, clusterMDCrypted, clusterMD);
-
-    // Some clusters have invalid data and metadata because they aren't
-    // meant to be read by the game (for example, holes between files). To
-    // try to avoid reporting errors because of these clusters, we check
-    // the 0x00 paddings in the metadata.
-    //
-    // This may cause some false negatives though: some bad clusters may be
-    // skipped because they are *too* bad and are not even recognized as
-    // valid clusters. To be improved.
-    bool meaningless = false;
-    for (u32 idx = 0x26C; idx < 0x280; ++idx)
-      if (clusterMD[idx] != 0)
-        meaningless = true;
-
-    if (meaningless)
-      continue;
-
-    u8 clusterData[0x7C00];
-    if (!Read((u64)clusterID * 0x7C00, 0x7C00, clusterData, partition))
-    {
-      WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: could not read data", clusterID);
-      return false;
-    }
-
-    for (u32 hashID = 0; hashID < 31; ++hashID)
-    {
-      u8 hash[20];
-
-      mbedtls_sha1(clusterData + hashID * 0x400, 0x400, hash);
-
-      // Note that we do not use strncmp here
-      if (memcmp(hash, clusterMD + hashID * 20, 20))
-      {
-        WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: hash %d is invalid", clusterID,
-                 hashID);
-        return false;
-      }
-    }
+    WARN_LOG(DISCIO, "Integrity Check: could not read the partition");
+  }
+  else if (!result.IsValid())
+  {
+    WARN_LOG(DISCIO, "Integrity Check: %" PRIu64 " of %" PRIu64 " clusters and %" PRIu64
+                     " groups have invalid hashes",
+             result.bad_clusters, result.clusters, result.bad_groups);
   }
+  INFO_LOG(DISCIO, "Integrity Check: scanned %" PRIu64 " clusters (%" PRIu64
+                   " without hashes) at %.1f MiB/s",
+           result.clusters, result.skipped_clusters, result.GetMiBPerSecond());
 
-  return true;
+  return result.IsValid();
 }
 
 }  // namespace
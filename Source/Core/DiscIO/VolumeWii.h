@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <array>
+#include <future>
 #include <map>
 #include <mbedtls/aes.h>
 #include <memory>
@@ -13,6 +15,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/Lazy.h"
+#include "Common/ThreadPool.h"
 #include "Core/IOS/ES/Formats.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
@@ -74,15 +77,47 @@ private:
     Common::Lazy<IOS::ES::TicketReader> ticket;
     Common::Lazy<IOS::ES::TMDReader> tmd;
     Common::Lazy<std::unique_ptr<FileSystem>> file_system;
+    // Offset on disc of the end of the encrypted data.
+    Common::Lazy<u64> data_end;
     u32 type;
   };
 
+  // The decrypted data of one block (cluster). Because offset_on_disc is the position of the
+  // encrypted block, it identifies both the partition and the block within it.
+  struct DecryptedBlock
+  {
+    u64 offset_on_disc = UINT64_MAX;
+    u64 last_used = 0;
+    std::vector<u8> data;
+    // Only used by blocks that get decrypted in the background.
+    std::vector<u8> encrypted_data;
+    // Valid while a worker thread is decrypting the block.
+    std::future<void> pending;
+  };
+
+  // Returns the decrypted block at the given offset, reading and decrypting it if needed.
+  const DecryptedBlock* GetDecryptedBlock(u64 block_offset_on_disc,
+                                          mbedtls_aes_context* aes_context,
+                                          u64 partition_data_end) const;
+  DecryptedBlock* FindDecryptedBlock(u64 block_offset_on_disc) const;
+  DecryptedBlock& GetLeastRecentlyUsedBlock() const;
+  void InitDecryptionPool() const;
+  void PrefetchBlock(u64 block_offset_on_disc, mbedtls_aes_context* aes_context,
+                     u64 partition_data_end) const;
+
   std::unique_ptr<BlobReader> m_pReader;
   std::map<Partition, PartitionDetails> m_partitions;
   Partition m_game_partition;
 
-  mutable u64 m_last_decrypted_block;
-  mutable u8 m_last_decrypted_block_data[BLOCK_DATA_SIZE];
+  static constexpr size_t DECRYPTED_BLOCK_CACHE_SIZE = 16;
+  mutable std::array<DecryptedBlock, DECRYPTED_BLOCK_CACHE_SIZE> m_decrypted_blocks;
+  mutable std::vector<u8> m_read_buffer;
+  mutable u64 m_decrypted_block_tick = 0;
+  mutable u64 m_last_block_offset_on_disc = UINT64_MAX;
+  mutable u32 m_sequential_blocks = 0;
+  mutable bool m_decryption_pool_initialized = false;
+  // Declared last so that it is destroyed (and its threads joined) first.
+  mutable Common::ThreadPool m_decryption_pool;
 };
 
 }  // namespace
@@ -0,0 +1,300 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/WiiPartitionScanner.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <future>
+#include <mbedtls/aes.h>
+#include <mbedtls/sha1.h>
+#include <optional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+#include "Common/ThreadPool.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace DiscIO
+{
+constexpr u64 CLUSTER_SIZE = VolumeWii::BLOCK_TOTAL_SIZE;
+constexpr u64 CLUSTER_HEADER_SIZE = VolumeWii::BLOCK_HEADER_SIZE;
+constexpr u64 CLUSTER_DATA_SIZE = VolumeWii::BLOCK_DATA_SIZE;
+constexpr u32 CLUSTERS_PER_SUBGROUP = 8;
+constexpr u32 SUBGROUPS_PER_GROUP = 8;
+constexpr u32 CLUSTERS_PER_GROUP = CLUSTERS_PER_SUBGROUP * SUBGROUPS_PER_GROUP;
+
+// The layout of the (decrypted) cluster header. http://wiibrew.org/wiki/Wii_Disc#Encrypted
+constexpr size_t SHA1_SIZE = 20;
+constexpr size_t H0_OFFSET = 0x000;
+constexpr size_t H0_COUNT = 31;
+constexpr size_t H0_PADDING_OFFSET = H0_OFFSET + H0_COUNT * SHA1_SIZE;
+constexpr size_t H1_OFFSET = 0x280;
+constexpr size_t H2_OFFSET = 0x340;
+constexpr size_t H1_TABLE_SIZE = CLUSTERS_PER_SUBGROUP * SHA1_SIZE;
+constexpr size_t H2_TABLE_SIZE = SUBGROUPS_PER_GROUP * SHA1_SIZE;
+constexpr size_t H3_TABLE_SIZE = 0x18000;
+constexpr u64 DATA_IV_OFFSET = 0x3D0;
+
+constexpr size_t MAX_SCANNER_THREADS = 8;
+
+namespace
+{
+struct Group
+{
+  u32 num_clusters = 0;
+  std::vector<u8> raw_data;
+  std::vector<u8> headers;
+  std::vector<u8> data;
+
+  u64 skipped_clusters = 0;
+  u64 bad_clusters = 0;
+  bool bad = false;
+};
+
+using SHA1 = std::array<u8, SHA1_SIZE>;
+
+SHA1 CalculateSHA1(const u8* data, size_t size)
+{
+  SHA1 hash;
+  mbedtls_sha1(data, size, hash.data());
+  return hash;
+}
+
+bool CheckSHA1(const SHA1& hash, const u8* expected)
+{
+  return std::memcmp(hash.data(), expected, SHA1_SIZE) == 0;
+}
+}
+
+// Decrypts a group and checks its hashes. h3_hash may be nullptr if the H3 table is missing.
+static void ProcessGroup(mbedtls_aes_context* aes_context, const u8* h3_hash, Group* group)
+{
+  group->skipped_clusters = 0;
+  group->bad_clusters = 0;
+  group->bad = false;
+
+  std::array<bool, CLUSTERS_PER_GROUP> has_hashes{};
+  std::array<bool, CLUSTERS_PER_GROUP> is_bad{};
+  std::array<SHA1, CLUSTERS_PER_GROUP> h0_table_hashes;
+
+  for (u32 i = 0; i < group->num_clusters; ++i)
+  {
+    u8* raw_cluster = &group->raw_data[i * CLUSTER_SIZE];
+    u8* header = &group->headers[i * CLUSTER_HEADER_SIZE];
+    u8* data = &group->data[i * CLUSTER_DATA_SIZE];
+
+    // The header uses an IV of zero, the data uses 0x3D0 - 0x3DF of the encrypted header.
+    u8 iv[16] = {};
+    mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, CLUSTER_HEADER_SIZE, iv, raw_cluster,
+                          header);
+    std::memcpy(iv, &raw_cluster[DATA_IV_OFFSET], sizeof(iv));
+    mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, CLUSTER_DATA_SIZE, iv,
+                          &raw_cluster[CLUSTER_HEADER_SIZE], data);
+
+    // Same heuristic as the old integrity check: clusters that aren't meant to be read by the
+    // game have garbage instead of the zero padding after the H0 hashes.
+    has_hashes[i] = std::all_of(&header[H0_PADDING_OFFSET], &header[H1_OFFSET],
+                                [](u8 byte) { return byte == 0; });
+    if (!has_hashes[i])
+    {
+      ++group->skipped_clusters;
+      continue;
+    }
+
+    for (u32 j = 0; j < H0_COUNT; ++j)
+    {
+      const SHA1 hash = CalculateSHA1(&data[j * 0x400], 0x400);
+      if (!CheckSHA1(hash, &header[H0_OFFSET + j * SHA1_SIZE]))
+        is_bad[i] = true;
+    }
+    h0_table_hashes[i] = CalculateSHA1(&header[H0_OFFSET], H0_COUNT * SHA1_SIZE);
+  }
+
+  // Every cluster of a subgroup has the H1 hashes of all clusters in the subgroup,
+  // and every cluster of a group has the H2 hashes of all subgroups in the group.
+  std::array<std::optional<SHA1>, SUBGROUPS_PER_GROUP> h1_table_hashes;
+  const u8* h2_table = nullptr;
+  for (u32 i = 0; i < group->num_clusters; ++i)
+  {
+    if (!has_hashes[i])
+      continue;
+
+    const u8* header = &group->headers[i * CLUSTER_HEADER_SIZE];
+    const u32 subgroup = i / CLUSTERS_PER_SUBGROUP;
+    const u32 subgroup_start = subgroup * CLUSTERS_PER_SUBGROUP;
+    for (u32 j = subgroup_start;
+         j < std::min(subgroup_start + CLUSTERS_PER_SUBGROUP, group->num_clusters); ++j)
+    {
+      if (has_hashes[j] &&
+          !CheckSHA1(h0_table_hashes[j], &header[H1_OFFSET + (j - subgroup_start) * SHA1_SIZE]))
+      {
+        is_bad[i] = true;
+      }
+    }
+
+    if (!h1_table_hashes[subgroup])
+      h1_table_hashes[subgroup] = CalculateSHA1(&header[H1_OFFSET], H1_TABLE_SIZE);
+    if (!h2_table)
+      h2_table = &header[H2_OFFSET];
+  }
+
+  for (u32 i = 0; i < group->num_clusters; ++i)
+  {
+    if (!has_hashes[i])
+      continue;
+
+    const u8* header = &group->headers[i * CLUSTER_HEADER_SIZE];
+    for (u32 j = 0; j < SUBGROUPS_PER_GROUP; ++j)
+    {
+      if (h1_table_hashes[j] && !CheckSHA1(*h1_table_hashes[j], &header[H2_OFFSET + j * SHA1_SIZE]))
+        group->bad = true;
+    }
+  }
+
+  if (h2_table && h3_hash && !CheckSHA1(CalculateSHA1(h2_table, H2_TABLE_SIZE), h3_hash))
+    group->bad = true;
+
+  group->bad_clusters = std::count(is_bad.begin(), is_bad.end(), true);
+}
+
+bool WiiPartitionScanResult::IsValid() const
+{
+  return !read_error && !cancelled && bad_clusters == 0 && bad_groups == 0;
+}
+
+double WiiPartitionScanResult::GetMiBPerSecond() const
+{
+  return seconds > 0.0 ? bytes_read / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+WiiPartitionScanResult ScanWiiPartition(const Volume& volume, const Partition& partition,
+                                        const WiiPartitionDataCallback& callback)
+{
+  WiiPartitionScanResult result;
+  const auto start_time = std::chrono::steady_clock::now();
+
+  const IOS::ES::TicketReader& ticket = volume.GetTicket(partition);
+  const std::optional<u64> h3_offset =
+      volume.ReadSwappedAndShifted(partition.offset + 0x2b4, PARTITION_NONE);
+  const std::optional<u64> data_offset =
+      volume.ReadSwappedAndShifted(partition.offset + 0x2b8, PARTITION_NONE);
+  const std::optional<u64> data_size =
+      volume.ReadSwappedAndShifted(partition.offset + 0x2bc, PARTITION_NONE);
+  if (!ticket.IsValid() || !data_offset || !data_size)
+  {
+    result.read_error = true;
+    return result;
+  }
+
+  mbedtls_aes_context aes_context;
+  mbedtls_aes_init(&aes_context);
+  const std::array<u8, 16> key = ticket.GetTitleKey();
+  mbedtls_aes_setkey_dec(&aes_context, key.data(), 128);
+
+  std::vector<u8> h3_table(H3_TABLE_SIZE);
+  const bool has_h3_table =
+      h3_offset && volume.Read(partition.offset + *h3_offset, H3_TABLE_SIZE, h3_table.data(),
+                               PARTITION_NONE);
+  if (!has_h3_table)
+    WARN_LOG(DISCIO, "Partition scan: could not read the H3 table, H3 hashes won't be checked");
+
+  const u64 num_clusters = *data_size / CLUSTER_SIZE;
+  const u64 num_groups = (num_clusters + CLUSTERS_PER_GROUP - 1) / CLUSTERS_PER_GROUP;
+
+  // The groups are read in order on this thread and processed on the workers. Each worker has
+  // two groups so that it can start on the next one while the results are being collected.
+  Common::ThreadPool pool(Common::ThreadPool::GetDefaultThreadCount(MAX_SCANNER_THREADS),
+                          "Wii Partition Scan");
+  std::vector<Group> groups(std::max<size_t>(pool.GetThreadCount(), 1) * 2);
+  std::vector<std::future<void>> pending(groups.size());
+  for (Group& group : groups)
+  {
+    group.raw_data.resize(CLUSTERS_PER_GROUP * CLUSTER_SIZE);
+    group.headers.resize(CLUSTERS_PER_GROUP * CLUSTER_HEADER_SIZE);
+    group.data.resize(CLUSTERS_PER_GROUP * CLUSTER_DATA_SIZE);
+  }
+
+  u64 groups_submitted = 0;
+  u64 groups_finished = 0;
+  const auto finish_group = [&] {
+    const size_t slot = groups_finished % groups.size();
+    Group& group = groups[slot];
+    if (pending[slot].valid())
+      pending[slot].get();
+
+    // Still wait for the remaining groups after an error, their buffers are in use.
+    if (!result.read_error && !result.cancelled)
+    {
+      result.clusters += group.num_clusters;
+      result.skipped_clusters += group.skipped_clusters;
+      result.bad_clusters += group.bad_clusters;
+      if (group.bad)
+        ++result.bad_groups;
+
+      const u64 offset = groups_finished * CLUSTERS_PER_GROUP * CLUSTER_DATA_SIZE;
+      if (callback && !callback(offset, group.data.data(), group.num_clusters * CLUSTER_DATA_SIZE))
+        result.cancelled = true;
+    }
+    ++groups_finished;
+  };
+
+  while (groups_submitted < num_groups && !result.read_error && !result.cancelled)
+  {
+    if (groups_submitted - groups_finished == groups.size())
+    {
+      finish_group();
+      continue;
+    }
+
+    const size_t slot = groups_submitted % groups.size();
+    Group& group = groups[slot];
+    group.num_clusters = static_cast<u32>(
+        std::min<u64>(CLUSTERS_PER_GROUP, num_clusters - groups_submitted * CLUSTERS_PER_GROUP));
+    const u64 offset = partition.offset + *data_offset +
+                       groups_submitted * CLUSTERS_PER_GROUP * CLUSTER_SIZE;
+    const u64 size = group.num_clusters * CLUSTER_SIZE;
+    if (!volume.Read(offset, size, group.raw_data.data(), PARTITION_NONE))
+    {
+      WARN_LOG(DISCIO, "Partition scan: could not read group %" PRIu64, groups_submitted);
+      result.read_error = true;
+      break;
+    }
+    result.bytes_read += size;
+
+    const u8* h3_hash = nullptr;
+    if (has_h3_table && (groups_submitted + 1) * SHA1_SIZE <= H3_TABLE_SIZE)
+      h3_hash = &h3_table[groups_submitted * SHA1_SIZE];
+
+    if (pool.GetThreadCount() == 0)
+    {
+      ProcessGroup(&aes_context, h3_hash, &group);
+    }
+    else
+    {
+      Group* group_ptr = &group;
+      pending[slot] = pool.Schedule([&aes_context, h3_hash, group_ptr] {
+        ProcessGroup(&aes_context, h3_hash, group_ptr);
+      });
+    }
+    ++groups_submitted;
+  }
+
+  while (groups_finished < groups_submitted)
+    finish_group();
+
+  mbedtls_aes_free(&aes_context);
+
+  result.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  return result;
+}
+
+}  // namespace DiscIO
@@ -0,0 +1,48 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "Common/CommonTypes.h"
+
+// Reads a whole Wii partition in groups of 64 clusters (2 MiB), and decrypts and checks the
+// H0-H3 hashes of the groups on worker threads. Much faster than going through
+// Volume::Read one cluster at a time.
+
+namespace DiscIO
+{
+struct Partition;
+class Volume;
+
+struct WiiPartitionScanResult
+{
+  bool read_error = false;
+  bool cancelled = false;
+  u64 clusters = 0;
+  // Clusters without valid hashes, for example holes between files or scrubbed data.
+  // Their hashes are not checked.
+  u64 skipped_clusters = 0;
+  // Clusters with a wrong H0 or H1 hash.
+  u64 bad_clusters = 0;
+  // Groups with a wrong H2 or H3 hash.
+  u64 bad_groups = 0;
+  u64 bytes_read = 0;
+  double seconds = 0.0;
+
+  bool IsValid() const;
+  double GetMiBPerSecond() const;
+};
+
+// Called for each group in order, with the decrypted data of its clusters. offset is the
+// offset of the data in the partition, as used by Volume::Read. Returning false cancels the scan.
+using WiiPartitionDataCallback =
+    std::function<bool(u64 offset, const u8* data, size_t size)>;
+
+WiiPartitionScanResult ScanWiiPartition(const Volume& volume, const Partition& partition,
+                                        const WiiPartitionDataCallback& callback = {});
+
+}  // namespace DiscIO
@@ -3,33 +3,44 @@
 // Refer to the license.txt file included.
 
 #include <OptionParser.h>
+#include <algorithm>
+#include <cinttypes>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <signal.h>
 #include <string>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/Flag.h"
 #include "Common/Logging/LogManager.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 
 #include "Core/Analytics.h"
 #include "Core/Boot/Boot.h"
 #include "Core/BootManager.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/Host.h"
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/STM/STM.h"
 #include "Core/State.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/WiiPartitionScanner.h"
 
 #include "UICommon/CommandLineParse.h"
 #include "UICommon/UICommon.h"
 
+#include "VideoCommon/PipelineTimings.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VR.h"
 #include "VideoCommon/VideoBackendBase.h"
@@ -349,6 +360,114 @@ class PlatformX11 : public Platform
 };
 #endif
 
+static void RunReplayBenchmark(int replays)
+{
+  StartOpcodeReplayBenchmark(replays);
+  while (s_running.IsSet() && !s_shutdown_requested.IsSet() && !IsOpcodeReplayBenchmarkDone())
+  {
+    Core::HostDispatchJobs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  if (IsOpcodeReplayBenchmarkDone())
+    printf("%s", GetOpcodeReplayBenchmarkReport().c_str());
+  else
+    fprintf(stderr, "Opcode replay benchmark was interrupted\n");
+}
+
+// The frame range of --fifo-benchmark, inclusive. The last frame defaults to the end of the log.
+static u32 s_fifo_benchmark_first_frame = 0;
+static u32 s_fifo_benchmark_last_frame = UINT32_MAX;
+
+// Called when the FIFO log has been loaded, before the first frame is played.
+static void SetUpFifoBenchmark()
+{
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  if (!player.GetFile())
+    return;
+
+  const u32 frame_count = player.GetFile()->GetFrameCount();
+  player.SetFrameRangeEnd(std::min(s_fifo_benchmark_last_frame, frame_count - 1) + 1);
+  player.SetFrameRangeStart(s_fifo_benchmark_first_frame);
+  player.SetLoop(true);
+  PipelineTimings::Start();
+}
+
+static int RunFifoBenchmark(int loops, const std::string& report_path)
+{
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  if (!player.GetFile())
+  {
+    fprintf(stderr, "--fifo-benchmark needs a FIFO log to be booted\n");
+    return 1;
+  }
+
+  const size_t frame_count =
+      static_cast<size_t>(loops) * (player.GetFrameRangeEnd() - player.GetFrameRangeStart());
+  while (s_running.IsSet() && !s_shutdown_requested.IsSet() &&
+         PipelineTimings::GetFrameCount() < frame_count)
+  {
+    Core::HostDispatchJobs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  PipelineTimings::Stop();
+
+  std::vector<PipelineTimings::FrameTimings> frames = PipelineTimings::GetFrames();
+  if (frames.size() > frame_count)
+    frames.resize(frame_count);
+  else if (frames.size() < frame_count)
+    fprintf(stderr, "FIFO benchmark was interrupted\n");
+
+  printf("%s", PipelineTimings::FormatSummary(frames).c_str());
+
+  if (!report_path.empty())
+  {
+    const std::string report = StringEndsWith(report_path, ".json") ?
+                                   PipelineTimings::FormatJSON(frames) :
+                                   PipelineTimings::FormatCSV(frames);
+    if (!File::WriteStringToFile(report, report_path))
+    {
+      fprintf(stderr, "Could not write %s\n", report_path.c_str());
+      return 1;
+    }
+  }
+
+  return frames.size() == frame_count ? 0 : 1;
+}
+
+static int VerifyDisc(const std::string& path)
+{
+  const std::unique_ptr<DiscIO::Volume> volume = DiscIO::CreateVolumeFromFilename(path);
+  if (!volume)
+  {
+    fprintf(stderr, "Could not open %s\n", path.c_str());
+    return 1;
+  }
+
+  const std::vector<DiscIO::Partition> partitions = volume->GetPartitions();
+  if (volume->GetVolumeType() != DiscIO::Platform::WII_DISC || partitions.empty())
+  {
+    fprintf(stderr, "%s is not a Wii disc with encrypted partitions\n", path.c_str());
+    return 1;
+  }
+
+  bool valid = true;
+  for (const DiscIO::Partition& partition : partitions)
+  {
+    const DiscIO::WiiPartitionScanResult result = DiscIO::ScanWiiPartition(*volume, partition);
+    printf("Partition at 0x%09" PRIx64 ": %s\n", partition.offset,
+           result.read_error ? "read error" : result.IsValid() ? "OK" : "BAD");
+    printf("  %" PRIu64 " clusters, %" PRIu64 " without hashes, %" PRIu64 " bad clusters, %" PRIu64
+           " bad groups\n",
+           result.clusters, result.skipped_clusters, result.bad_clusters, result.bad_groups);
+    printf("  %.1f MiB in %.2f s (%.1f MiB/s)\n", result.bytes_read / (1024.0 * 1024.0),
+           result.seconds, result.GetMiBPerSecond());
+    valid &= result.IsValid();
+  }
+
+  return valid ? 0 : 2;
+}
+
 static Platform* GetPlatform()
 {
 #if defined(USE_HEADLESS)
@@ -365,6 +484,24 @@ int main(int argc, char* argv[])
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
+  if (options.is_set("verify_disc"))
+    return VerifyDisc(static_cast<const char*>(options.get("verify_disc")));
+
+  if (options.is_set("fifo_benchmark_frames"))
+  {
+    const std::string range = static_cast<const char*>(options.get("fifo_benchmark_frames"));
+    if (sscanf(range.c_str(), "%u-%u", &s_fifo_benchmark_first_frame,
+               &s_fifo_benchmark_last_frame) != 2 ||
+        s_fifo_benchmark_first_frame > s_fifo_benchmark_last_frame)
+    {
+      fprintf(stderr, "Invalid frame range\n");
+      parser->print_help();
+      return 1;
+    }
+  }
+  if (options.is_set("fifo_benchmark"))
+    FifoPlayer::GetInstance().SetFileLoadedCallback(SetUpFifoBenchmark);
+
   std::unique_ptr<BootParameters> boot;
   if (options.is_set("exec"))
   {
@@ -437,8 +574,23 @@ int main(int argc, char* argv[])
     updateMainFrameEvent.Wait();
   }
 
+  int exit_code = 0;
   if (s_running.IsSet())
-    platform->MainLoop();
+  {
+    if (options.is_set("replay_benchmark"))
+    {
+      RunReplayBenchmark(static_cast<int>(options.get("replay_benchmark")));
+    }
+    else if (options.is_set("fifo_benchmark"))
+    {
+      exit_code = RunFifoBenchmark(static_cast<int>(options.get("fifo_benchmark")),
+                                   static_cast<const char*>(options.get("fifo_benchmark_report")));
+    }
+    else
+    {
+      platform->MainLoop();
+    }
+  }
   Core::Stop();
 
   Core::Shutdown();
@@ -447,5 +599,5 @@ int main(int argc, char* argv[])
 
   delete platform;
 
-  return 0;
+  return exit_code;
 }
@@ -370,5 +370,8 @@ void HotkeyScheduler::Run()
 
     if (IsHotkey(HK_UNDO_SAVE_STATE))
       State::UndoSaveState();
+
+    if (IsHotkey(HK_REWIND))
+      State::Rewind();
   }
 }
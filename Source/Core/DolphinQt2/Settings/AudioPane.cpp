@@ -71,6 +71,8 @@ void AudioPane::CreateWidgets()
   m_backend_label = new QLabel(tr("Audio Backend:"));
   m_backend_combo = new QComboBox();
   m_dolby_pro_logic = new QCheckBox(tr("Dolby Pro Logic II Decoder"));
+  m_sinc_resampling = new QCheckBox(tr("High Quality Resampling"));
+  m_show_statistics = new QCheckBox(tr("Show Buffer Statistics"));
 
   if (m_latency_control_supported)
   {
@@ -84,11 +86,19 @@ void AudioPane::CreateWidgets()
 
   m_dolby_pro_logic->setToolTip(
       tr("Enables Dolby Pro Logic II emulation using 5.1 surround. Certain backends only."));
+  m_sinc_resampling->setToolTip(
+      tr("Converts sample rates with a windowed sinc filter instead of linear interpolation. "
+         "Sounds clearer, at a small CPU cost."));
+  m_show_statistics->setToolTip(
+      tr("Shows how much audio is buffered, and how often the buffers ran empty or overflowed, "
+         "on screen. Useful for tuning the latency."));
 
   backend_layout->addRow(m_backend_label, m_backend_combo);
   if (m_latency_control_supported)
     backend_layout->addRow(m_latency_label, m_latency_spin);
   backend_layout->addRow(m_dolby_pro_logic);
+  backend_layout->addRow(m_sinc_resampling);
+  backend_layout->addRow(m_show_statistics);
 
   auto* stretching_box = new QGroupBox(tr("Audio Stretching Settings"));
   auto* stretching_layout = new QGridLayout;
@@ -134,6 +144,8 @@ void AudioPane::ConnectWidgets()
   }
   connect(m_stretching_buffer_slider, &QSlider::valueChanged, this, &AudioPane::SaveSettings);
   connect(m_dolby_pro_logic, &QCheckBox::toggled, this, &AudioPane::SaveSettings);
+  connect(m_sinc_resampling, &QCheckBox::toggled, this, &AudioPane::SaveSettings);
+  connect(m_show_statistics, &QCheckBox::toggled, this, &AudioPane::SaveSettings);
   connect(m_stretching_enable, &QCheckBox::toggled, this, &AudioPane::SaveSettings);
   connect(m_dsp_hle, &QRadioButton::toggled, this, &AudioPane::SaveSettings);
   connect(m_dsp_lle, &QRadioButton::toggled, this, &AudioPane::SaveSettings);
@@ -172,6 +184,10 @@ void AudioPane::LoadSettings()
   // DPL2
   m_dolby_pro_logic->setChecked(SConfig::GetInstance().bDPL2Decoder);
 
+  // Resampling
+  m_sinc_resampling->setChecked(SConfig::GetInstance().m_audio_sinc_resampling);
+  m_show_statistics->setChecked(SConfig::GetInstance().m_ShowAudioStats);
+
   // Latency
   if (m_latency_control_supported)
     m_latency_spin->setValue(SConfig::GetInstance().iLatency);
@@ -212,6 +228,10 @@ void AudioPane::SaveSettings()
   // DPL2
   SConfig::GetInstance().bDPL2Decoder = m_dolby_pro_logic->isChecked();
 
+  // Resampling
+  SConfig::GetInstance().m_audio_sinc_resampling = m_sinc_resampling->isChecked();
+  SConfig::GetInstance().m_ShowAudioStats = m_show_statistics->isChecked();
+
   // Latency
   if (m_latency_control_supported)
     SConfig::GetInstance().iLatency = m_latency_spin->value();
@@ -50,6 +50,8 @@ private:
   QLabel* m_backend_label;
   QComboBox* m_backend_combo;
   QCheckBox* m_dolby_pro_logic;
+  QCheckBox* m_sinc_resampling;
+  QCheckBox* m_show_statistics;
   QLabel* m_latency_label;
   QSpinBox* m_latency_spin;
 
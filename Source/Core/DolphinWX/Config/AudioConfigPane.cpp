@@ -40,6 +40,8 @@ void AudioConfigPane::InitializeGUI()
       new wxRadioBox(this, wxID_ANY, _("DSP Emulation Engine"), wxDefaultPosition, wxDefaultSize,
                      m_dsp_engine_strings, 0, wxRA_SPECIFY_ROWS);
   m_dpl2_decoder_checkbox = new wxCheckBox(this, wxID_ANY, _("Dolby Pro Logic II Decoder"));
+  m_sinc_resampling_checkbox = new wxCheckBox(this, wxID_ANY, _("High Quality Resampling"));
+  m_show_statistics_checkbox = new wxCheckBox(this, wxID_ANY, _("Show Buffer Statistics"));
   m_volume_slider = new DolphinSlider(this, wxID_ANY, 0, 0, 100, wxDefaultPosition, wxDefaultSize,
                                       wxSL_VERTICAL | wxSL_INVERSE);
   m_volume_text = new wxStaticText(this, wxID_ANY, "");
@@ -66,6 +68,12 @@ void AudioConfigPane::InitializeGUI()
   }
   m_dpl2_decoder_checkbox->SetToolTip(
       _("Enables Dolby Pro Logic II emulation using 5.1 surround. Certain backends only."));
+  m_sinc_resampling_checkbox->SetToolTip(
+      _("Converts sample rates with a windowed sinc filter instead of linear interpolation. "
+        "Sounds clearer, at a small CPU cost."));
+  m_show_statistics_checkbox->SetToolTip(
+      _("Shows how much audio is buffered, and how often the buffers ran empty or overflowed, "
+        "on screen. Useful for tuning the latency."));
   m_stretch_checkbox->SetToolTip(_("Enables stretching of the audio to match emulation speed."));
   m_stretch_slider->SetToolTip(_("Size of stretch buffer in milliseconds. "
                                  "Values too low may cause audio crackling."));
@@ -84,11 +92,15 @@ void AudioConfigPane::InitializeGUI()
                           wxALIGN_CENTER_VERTICAL);
   backend_grid_sizer->Add(m_dpl2_decoder_checkbox, wxGBPosition(1, 0), wxGBSpan(1, 2),
                           wxALIGN_CENTER_VERTICAL);
+  backend_grid_sizer->Add(m_sinc_resampling_checkbox, wxGBPosition(2, 0), wxGBSpan(1, 2),
+                          wxALIGN_CENTER_VERTICAL);
+  backend_grid_sizer->Add(m_show_statistics_checkbox, wxGBPosition(3, 0), wxGBSpan(1, 2),
+                          wxALIGN_CENTER_VERTICAL);
   if (m_latency_control_supported)
   {
-    backend_grid_sizer->Add(m_audio_latency_label, wxGBPosition(2, 0), wxDefaultSpan,
+    backend_grid_sizer->Add(m_audio_latency_label, wxGBPosition(4, 0), wxDefaultSpan,
                             wxALIGN_CENTER_VERTICAL);
-    backend_grid_sizer->Add(m_audio_latency_spinctrl, wxGBPosition(2, 1), wxDefaultSpan,
+    backend_grid_sizer->Add(m_audio_latency_spinctrl, wxGBPosition(4, 1), wxDefaultSpan,
                             wxALIGN_CENTER_VERTICAL);
   }
 
@@ -150,6 +162,8 @@ void AudioConfigPane::LoadGUIValues()
   m_volume_slider->SetValue(SConfig::GetInstance().m_Volume);
   m_volume_text->SetLabel(wxString::Format("%d %%", SConfig::GetInstance().m_Volume));
   m_dpl2_decoder_checkbox->SetValue(startup_params.bDPL2Decoder);
+  m_sinc_resampling_checkbox->SetValue(startup_params.m_audio_sinc_resampling);
+  m_show_statistics_checkbox->SetValue(startup_params.m_ShowAudioStats);
   if (m_latency_control_supported)
   {
     m_audio_latency_spinctrl->SetValue(startup_params.iLatency);
@@ -187,6 +201,11 @@ void AudioConfigPane::BindEvents()
                                 this);
   m_dpl2_decoder_checkbox->Bind(wxEVT_UPDATE_UI, &WxEventUtils::OnEnableIfCoreNotRunning);
 
+  m_sinc_resampling_checkbox->Bind(wxEVT_CHECKBOX,
+                                   &AudioConfigPane::OnSincResamplingCheckBoxChanged, this);
+  m_show_statistics_checkbox->Bind(wxEVT_CHECKBOX,
+                                   &AudioConfigPane::OnShowStatisticsCheckBoxChanged, this);
+
   m_volume_slider->Bind(wxEVT_SLIDER, &AudioConfigPane::OnVolumeSliderChanged, this);
 
   m_audio_backend_choice->Bind(wxEVT_CHOICE, &AudioConfigPane::OnAudioBackendChanged, this);
@@ -215,6 +234,16 @@ void AudioConfigPane::OnDPL2DecoderCheckBoxChanged(wxCommandEvent&)
   SConfig::GetInstance().bDPL2Decoder = m_dpl2_decoder_checkbox->IsChecked();
 }
 
+void AudioConfigPane::OnSincResamplingCheckBoxChanged(wxCommandEvent&)
+{
+  SConfig::GetInstance().m_audio_sinc_resampling = m_sinc_resampling_checkbox->IsChecked();
+}
+
+void AudioConfigPane::OnShowStatisticsCheckBoxChanged(wxCommandEvent&)
+{
+  SConfig::GetInstance().m_ShowAudioStats = m_show_statistics_checkbox->IsChecked();
+}
+
 void AudioConfigPane::OnVolumeSliderChanged(wxCommandEvent& event)
 {
   SConfig::GetInstance().m_Volume = m_volume_slider->GetValue();
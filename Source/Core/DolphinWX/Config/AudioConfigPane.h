@@ -31,6 +31,8 @@ private:
 
   void OnDSPEngineRadioBoxChanged(wxCommandEvent&);
   void OnDPL2DecoderCheckBoxChanged(wxCommandEvent&);
+  void OnSincResamplingCheckBoxChanged(wxCommandEvent&);
+  void OnShowStatisticsCheckBoxChanged(wxCommandEvent&);
   void OnVolumeSliderChanged(wxCommandEvent&);
   void OnAudioBackendChanged(wxCommandEvent&);
   void OnLatencySpinCtrlChanged(wxCommandEvent&);
@@ -42,6 +44,8 @@ private:
 
   wxRadioBox* m_dsp_engine_radiobox;
   wxCheckBox* m_dpl2_decoder_checkbox;
+  wxCheckBox* m_sinc_resampling_checkbox;
+  wxCheckBox* m_show_statistics_checkbox;
   DolphinSlider* m_volume_slider;
   wxStaticText* m_volume_text;
   wxChoice* m_audio_backend_choice;
@@ -169,6 +169,10 @@ void FifoPlayerDlg::CreateGUIControls()
     m_FramesToRecordCtrl =
         new wxSpinCtrl(m_RecordPage, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
                        wxSP_ARROW_KEYS, 0, 10000, m_FramesToRecord);
+    m_CompressRecording = new wxCheckBox(m_RecordPage, wxID_ANY, _("Compress"));
+    m_CompressRecording->SetToolTip(
+        _("Compresses the memory updates of the saved file. Older versions of Dolphin can't "
+          "play back compressed files."));
 
     wxStaticBoxSizer* sRecordInfo =
         new wxStaticBoxSizer(wxVERTICAL, m_RecordPage, _("Recording Info"));
@@ -193,6 +197,9 @@ void FifoPlayerDlg::CreateGUIControls()
     sRecordingOptions->Add(m_FramesToRecordCtrl, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxBOTTOM,
                            space5);
     sRecordingOptions->AddSpacer(space5);
+    sRecordingOptions->Add(m_CompressRecording, 0, wxALIGN_CENTER_VERTICAL | wxTOP | wxBOTTOM,
+                           space5);
+    sRecordingOptions->AddSpacer(space5);
 
     wxBoxSizer* sRecordPage = new wxBoxSizer(wxVERTICAL);
     sRecordPage->Add(sRecordInfo, 0, wxEXPAND);
@@ -384,7 +391,7 @@ void FifoPlayerDlg::OnSaveFile(wxCommandEvent& WXUNUSED(event))
     {
       // Attempt to save the file to the path the user chose
       wxBeginBusyCursor();
-      bool result = file->Save(WxStrToStr(path));
+      bool result = file->Save(WxStrToStr(path), m_CompressRecording->IsChecked());
       wxEndBusyCursor();
 
       // Wasn't able to save the file, shit's whack, yo.
@@ -470,8 +477,9 @@ void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
     return;
   }
 
-  const u8* const start_ptr = &fifo_frame.fifoData[frame.objectStarts[obj_idx]];
-  const u8* const end_ptr = &fifo_frame.fifoData[frame.objectStarts[obj_idx + 1]];
+  const u8* const fifo_data = fifo_frame.fifoData->GetData();
+  const u8* const start_ptr = &fifo_data[frame.objectStarts[obj_idx]];
+  const u8* const end_ptr = &fifo_data[frame.objectStarts[obj_idx + 1]];
 
   for (const u8* ptr = start_ptr; ptr < end_ptr - val_length + 1; ++ptr)
   {
@@ -624,10 +632,11 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
   {
     const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
     const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
-    const u8* objectdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx]];
-    const u8* objectdata_end = &fifo_frame.fifoData[frame.objectEnds[object_idx]];
+    const u8* const fifo_data = fifo_frame.fifoData->GetData();
+    const u8* objectdata_start = &fifo_data[frame.objectStarts[object_idx]];
+    const u8* objectdata_end = &fifo_data[frame.objectEnds[object_idx]];
     u8* objectdata = (u8*)objectdata_start;
-    const int obj_offset = objectdata_start - &fifo_frame.fifoData[frame.objectStarts[0]];
+    const int obj_offset = objectdata_start - &fifo_data[frame.objectStarts[0]];
 
     int cmd = *objectdata++;
     int stream_size = Common::swap16(objectdata);
@@ -667,11 +676,11 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
     // Between objectdata_end and next_objdata_start, there are register setting commands
     if (object_idx + 1 < (int)frame.objectStarts.size())
     {
-      const u8* next_objdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx + 1]];
+      const u8* next_objdata_start = &fifo_data[frame.objectStarts[object_idx + 1]];
       while (objectdata < next_objdata_start)
       {
         m_objectCmdOffsets.push_back(objectdata - objectdata_start);
-        int new_offset = objectdata - &fifo_frame.fifoData[frame.objectStarts[0]];
+        int new_offset = objectdata - &fifo_data[frame.objectStarts[0]];
         int command = *objectdata++;
         switch (command)
         {
@@ -782,8 +791,8 @@ void FifoPlayerDlg::OnObjectCmdListSelectionChanged(wxCommandEvent& event)
   FifoPlayer& player = FifoPlayer::GetInstance();
   const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
   const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
-  const u8* cmddata =
-      &fifo_frame.fifoData[frame.objectStarts[object_idx]] + m_objectCmdOffsets[event.GetInt()];
+  const u8* cmddata = &fifo_frame.fifoData->GetData()[frame.objectStarts[object_idx]] +
+                      m_objectCmdOffsets[event.GetInt()];
 
   // TODO: Not sure whether we should bother translating the descriptions
   wxString newLabel;
@@ -933,7 +942,7 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
   {
     size_t fifoBytes = 0;
     for (size_t i = 0; i < file->GetFrameCount(); ++i)
-      fifoBytes += file->GetFrame(i).fifoData.size();
+      fifoBytes += file->GetFrame(i).fifoData->GetSize();
 
     return wxString::Format(_("%zu FIFO bytes"), fifoBytes);
   }
@@ -952,7 +961,7 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
     {
       const std::vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
       for (const auto& memUpdate : memUpdates)
-        memBytes += memUpdate.data.size();
+        memBytes += memUpdate.data->GetSize();
     }
 
     return wxString::Format(_("%zu memory bytes"), memBytes);
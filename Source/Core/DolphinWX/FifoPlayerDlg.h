@@ -97,6 +97,7 @@ private:
   wxButton* m_Save;
   wxStaticText* m_FramesToRecordLabel;
   wxSpinCtrl* m_FramesToRecordCtrl;
+  wxCheckBox* m_CompressRecording;
 
   wxPanel* m_AnalyzePage;
   wxListBox* m_framesList;
@@ -2009,6 +2009,8 @@ void CFrame::ParseHotkeys()
     State::UndoLoadState();
   if (IsHotkey(HK_UNDO_SAVE_STATE))
     State::UndoSaveState();
+  if (IsHotkey(HK_REWIND))
+    State::Rewind();
 }
 
 void CFrame::HandleFrameSkipHotkeys()
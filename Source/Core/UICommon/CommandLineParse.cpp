@@ -94,6 +94,35 @@ std::unique_ptr<optparse::OptionParser> CreateParser(ParserOptions options)
     parser->add_option("-b", "--batch").action("store_true").help("Exit Dolphin with emulation");
     parser->add_option("-c", "--confirm").action("store_true").help("Set Confirm on Stop");
   }
+  else
+  {
+    parser->add_option("--replay-benchmark")
+        .action("store")
+        .type("int")
+        .metavar("<replays>")
+        .help("Record one frame into the opcode replay buffer, replay it the given number of "
+              "times, print the replay throughput and exit");
+    parser->add_option("--fifo-benchmark")
+        .action("store")
+        .type("int")
+        .metavar("<loops>")
+        .help("Play the booted FIFO log the given number of times, print the time spent in "
+              "each stage of the video pipeline and exit");
+    parser->add_option("--fifo-benchmark-frames")
+        .action("store")
+        .metavar("<first>-<last>")
+        .help("Only play the given range of frames of the FIFO log in --fifo-benchmark");
+    parser->add_option("--fifo-benchmark-report")
+        .action("store")
+        .metavar("<file>")
+        .help("Write the timings of every frame of --fifo-benchmark to a file, as JSON if its "
+              "name ends with .json and as CSV otherwise");
+    parser->add_option("--verify-disc")
+        .action("store")
+        .metavar("<file>")
+        .help("Check the hashes of every partition of a Wii disc image, print the results and "
+              "exit");
+  }
 
   parser->set_defaults("video_backend", "");
   parser->set_defaults("audio_emulation", "");
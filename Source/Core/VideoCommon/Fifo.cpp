@@ -299,7 +299,7 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 
 #ifdef INLINE_OPCODE
   // Render Extra Headtracking Frames for VR.
-  if (g_new_frame_just_rendered && g_has_hmd)
+  if (g_new_frame_just_rendered && (g_has_hmd || IsOpcodeReplayBenchmarkRunning()))
   {
     OpcodeReplayBufferInline();
   }
@@ -352,7 +352,8 @@ void RunGpuLoop()
 
 #ifdef INLINE_OPCODE
             // Render Extra Headtracking Frames for VR.
-            if (g_new_frame_just_rendered && g_has_hmd)
+            if (g_new_frame_just_rendered &&
+                (g_has_hmd || IsOpcodeReplayBenchmarkRunning()))
             {
               OpcodeReplayBufferInline();
             }
@@ -402,7 +403,8 @@ void RunGpuLoop()
 
 #ifdef INLINE_OPCODE
             // Render Extra Headtracking Frames for VR.
-            if (g_new_frame_just_rendered && g_has_hmd)
+            if (g_new_frame_just_rendered &&
+                (g_has_hmd || IsOpcodeReplayBenchmarkRunning()))
             {
               OpcodeReplayBufferInline();
             }
@@ -517,7 +519,7 @@ static int RunGpuOnCpu(int ticks)
 
 #ifdef INLINE_OPCODE
       // Render Extra Headtracking Frames for VR.
-      if (g_new_frame_just_rendered && g_has_hmd)
+      if (g_new_frame_just_rendered && (g_has_hmd || IsOpcodeReplayBenchmarkRunning()))
       {
         OpcodeReplayBufferInline();
       }
@@ -28,6 +28,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/PipelineTimings.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VR.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -96,14 +97,14 @@ void Shutdown()
   {
     g_opcode_replay_frame = false;
     g_opcode_replay_log_frame = false;
-    timewarp_logentries.clear();
-    timewarp_logentries.resize(0);
+    g_opcode_replay_log.Clear();
   }
 }
 
 template <bool is_preprocess>
 u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
 {
+  PipelineTimings::ScopedStage timing(PipelineTimings::Stage::OpcodeDecoding, !is_preprocess);
   u32 totalCycles = 0;
   u8* opcodeStart;
 
@@ -124,7 +125,7 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, bool recursive_call)
   if (g_opcode_replay_log_frame && !g_opcode_replay_frame && !recursive_call &&
       (skipped_opcode_replay_count >= (int)g_ActiveConfig.iExtraVideoLoopsDivider))
   {
-    timewarp_logentries.push_back(TimewarpLogEntry{src, is_preprocess});
+    g_opcode_replay_log.Record(src.GetPointer(), src.size(), is_preprocess);
 
     if (in_display_list)
     {
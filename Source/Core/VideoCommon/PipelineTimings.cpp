@@ -0,0 +1,197 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/PipelineTimings.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "Common/StringUtil.h"
+
+namespace PipelineTimings
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr int NO_STAGE = -1;
+
+static std::atomic<bool> s_active{false};
+static std::array<std::atomic<u64>, NUM_STAGES> s_stage_ns;
+
+// The stages can run on the GPU thread and the CPU thread, so nesting is tracked per thread.
+static thread_local int s_current_stage = NO_STAGE;
+static thread_local Clock::time_point s_last_switch;
+
+static std::mutex s_frames_lock;
+static std::vector<FrameTimings> s_frames;
+static Clock::time_point s_frame_start;
+static u32 s_loop;
+
+static const char* const s_stage_names[NUM_STAGES] = {"opcode_decoding", "vertex_loading",
+                                                       "texture_decoding", "flush"};
+
+static double ToMilliseconds(u64 ns)
+{
+  return ns / 1000000.0;
+}
+
+// Counts the time since the last stage switch on this thread as spent in the current stage.
+static void SwitchStage(int stage)
+{
+  const Clock::time_point now = Clock::now();
+  if (s_current_stage != NO_STAGE)
+  {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_last_switch);
+    s_stage_ns[s_current_stage].fetch_add(elapsed.count(), std::memory_order_relaxed);
+  }
+  s_current_stage = stage;
+  s_last_switch = now;
+}
+
+const char* GetStageName(Stage stage)
+{
+  return s_stage_names[static_cast<size_t>(stage)];
+}
+
+void Start()
+{
+  std::lock_guard<std::mutex> lk(s_frames_lock);
+  s_frames.clear();
+  for (std::atomic<u64>& ns : s_stage_ns)
+    ns.store(0, std::memory_order_relaxed);
+  s_frame_start = Clock::now();
+  s_loop = 0;
+  s_active.store(true);
+}
+
+void Stop()
+{
+  s_active.store(false);
+}
+
+bool IsActive()
+{
+  return s_active.load(std::memory_order_relaxed);
+}
+
+ScopedStage::ScopedStage(Stage stage, bool measure) : m_active(measure && IsActive())
+{
+  if (!m_active)
+    return;
+
+  m_previous_stage = s_current_stage;
+  SwitchStage(static_cast<int>(stage));
+}
+
+ScopedStage::~ScopedStage()
+{
+  if (m_active)
+    SwitchStage(m_previous_stage);
+}
+
+void EndFrame(u32 frame)
+{
+  if (!IsActive())
+    return;
+
+  FrameTimings timings;
+  timings.frame = frame;
+  for (size_t i = 0; i < NUM_STAGES; ++i)
+    timings.stage_ns[i] = s_stage_ns[i].exchange(0, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lk(s_frames_lock);
+  const Clock::time_point now = Clock::now();
+  timings.total_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - s_frame_start).count();
+  s_frame_start = now;
+
+  // Playback went back to the start of the frame range.
+  if (!s_frames.empty() && frame <= s_frames.back().frame)
+    ++s_loop;
+  timings.loop = s_loop;
+
+  s_frames.push_back(timings);
+}
+
+size_t GetFrameCount()
+{
+  std::lock_guard<std::mutex> lk(s_frames_lock);
+  return s_frames.size();
+}
+
+std::vector<FrameTimings> GetFrames()
+{
+  std::lock_guard<std::mutex> lk(s_frames_lock);
+  return s_frames;
+}
+
+std::string FormatCSV(const std::vector<FrameTimings>& frames)
+{
+  std::string csv = "loop,frame,total_ms";
+  for (const char* name : s_stage_names)
+    csv += StringFromFormat(",%s_ms", name);
+  csv += '\n';
+
+  for (const FrameTimings& timings : frames)
+  {
+    csv += StringFromFormat("%u,%u,%.4f", timings.loop, timings.frame,
+                            ToMilliseconds(timings.total_ns));
+    for (u64 ns : timings.stage_ns)
+      csv += StringFromFormat(",%.4f", ToMilliseconds(ns));
+    csv += '\n';
+  }
+
+  return csv;
+}
+
+std::string FormatJSON(const std::vector<FrameTimings>& frames)
+{
+  std::string json = "{\n  \"frames\": [";
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    const FrameTimings& timings = frames[i];
+    json += StringFromFormat("%s\n    {\"loop\": %u, \"frame\": %u, \"total_ms\": %.4f",
+                             i ? "," : "", timings.loop, timings.frame,
+                             ToMilliseconds(timings.total_ns));
+    for (size_t stage = 0; stage < NUM_STAGES; ++stage)
+    {
+      json += StringFromFormat(", \"%s_ms\": %.4f", s_stage_names[stage],
+                               ToMilliseconds(timings.stage_ns[stage]));
+    }
+    json += "}";
+  }
+  json += "\n  ]\n}\n";
+
+  return json;
+}
+
+std::string FormatSummary(const std::vector<FrameTimings>& frames)
+{
+  if (frames.empty())
+    return "No frames were recorded\n";
+
+  u64 total_ns = 0;
+  u64 max_ns = 0;
+  std::array<u64, NUM_STAGES> stage_ns{};
+  for (const FrameTimings& timings : frames)
+  {
+    total_ns += timings.total_ns;
+    max_ns = std::max(max_ns, timings.total_ns);
+    for (size_t i = 0; i < NUM_STAGES; ++i)
+      stage_ns[i] += timings.stage_ns[i];
+  }
+
+  std::string summary = StringFromFormat(
+      "%zu frames in %.2f s: %.3f ms per frame on average, %.3f ms at most\n", frames.size(),
+      total_ns / 1000000000.0, ToMilliseconds(total_ns / frames.size()), ToMilliseconds(max_ns));
+  for (size_t i = 0; i < NUM_STAGES; ++i)
+  {
+    summary += StringFromFormat("  %-17s %.3f ms per frame\n", s_stage_names[i],
+                                ToMilliseconds(stage_ns[i] / frames.size()));
+  }
+
+  return summary;
+}
+}  // namespace PipelineTimings
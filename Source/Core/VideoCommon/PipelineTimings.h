@@ -0,0 +1,72 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Per-frame timings of the stages of the video pipeline, used to benchmark FIFO log playback.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace PipelineTimings
+{
+enum class Stage
+{
+  OpcodeDecoding,
+  VertexLoading,
+  TextureDecoding,
+  Flush,
+  Count
+};
+constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::Count);
+
+struct FrameTimings
+{
+  // The FIFO log frame, and how many times the frame range had been played before it.
+  u32 frame;
+  u32 loop;
+  // Wall time between the end of the previous frame and the end of this one.
+  u64 total_ns;
+  // Time spent in each stage, not counting the stages nested in it.
+  std::array<u64, NUM_STAGES> stage_ns;
+};
+
+const char* GetStageName(Stage stage);
+
+// Discards the recorded frames and starts measuring.
+void Start();
+void Stop();
+bool IsActive();
+
+// Counts the time until it goes out of scope as spent in the given stage. When stages are
+// nested, time is only counted for the innermost one.
+class ScopedStage
+{
+public:
+  explicit ScopedStage(Stage stage, bool measure = true);
+  ~ScopedStage();
+
+  ScopedStage(const ScopedStage&) = delete;
+  ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+  bool m_active;
+  int m_previous_stage;
+};
+
+// Called by the FIFO player once the GPU has finished processing a frame.
+void EndFrame(u32 frame);
+
+size_t GetFrameCount();
+std::vector<FrameTimings> GetFrames();
+
+std::string FormatCSV(const std::vector<FrameTimings>& frames);
+std::string FormatJSON(const std::vector<FrameTimings>& frames);
+// A short human-readable summary: the average time per frame, overall and for each stage.
+std::string FormatSummary(const std::vector<FrameTimings>& frames);
+}  // namespace PipelineTimings
@@ -26,6 +26,7 @@
 #include <string>
 #include <tuple>
 
+#include "AudioCommon/AudioCommon.h"
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
 #include "Common/Config/Config.h"
@@ -66,6 +67,7 @@
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VR.h"
@@ -411,6 +413,13 @@ void Renderer::DrawDebugText()
     final_yellow += "\n";
   }
 
+  if (SConfig::GetInstance().m_ShowAudioStats)
+  {
+    // One line for each of the mixer's FIFOs.
+    final_cyan += AudioCommon::GetStatisticsDisplay();
+    final_yellow += "\n\n\n";
+  }
+
   // OSD Menu messages
   if (OSDChoice > 0)
   {
@@ -801,6 +810,7 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
   // Set default viewport and scissor, for the clear to work correctly
   // New frame
   stats.ResetFrame();
+  VertexLoaderManager::RefreshHideObjectMatcher();
 
   Core::Callback_VideoCopiedToXFB(
       (m_xfb_written || (g_ActiveConfig.bUseXFB && g_ActiveConfig.bUseRealXFB)) &&
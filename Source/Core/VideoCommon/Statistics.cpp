@@ -67,6 +67,8 @@ std::string Statistics::ToString()
   str += StringFromFormat("Vertex streamed: %i kB\n", stats.thisFrame.bytesVertexStreamed / 1024);
   str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed / 1024);
   str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed / 1024);
+  str += StringFromFormat("Hide object probes: %i\n", stats.thisFrame.numHideObjectProbes);
+  str += StringFromFormat("Hidden objects: %i\n", stats.thisFrame.numHiddenObjects);
   str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
 
   std::string vertex_list = VertexLoaderManager::VertexLoadersToString();
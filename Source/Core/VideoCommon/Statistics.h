@@ -61,6 +61,9 @@ struct Statistics
     int numVerticesLoaded;
     int tevPixelsIn;
     int tevPixelsOut;
+
+    int numHideObjectProbes;
+    int numHiddenObjects;
   };
   ThisFrame thisFrame, prevFrame;
   void ResetFrame();
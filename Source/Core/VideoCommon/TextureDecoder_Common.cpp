@@ -10,6 +10,7 @@
 #include "Common/Swap.h"
 
 #include "VideoCommon/LookUpTables.h"
+#include "VideoCommon/PipelineTimings.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/TextureDecoder_Util.h"
 #include "VideoCommon/sfont.inc"
@@ -299,6 +300,7 @@ static void TexDecoder_DrawOverlay(u8* dst, int width, int height, TextureFormat
 void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFormat texformat,
                        const u8* tlut, TLUTFormat tlutfmt)
 {
+  PipelineTimings::ScopedStage timing(PipelineTimings::Stage::TextureDecoding);
   _TexDecoder_DecodeImpl((u32*)dst, src, width, height, texformat, tlut, tlutfmt);
 
   if (TexFmt_Overlay_Enable)
@@ -13,6 +13,7 @@
 #endif
 
 #include "Common/Common.h"
+#include "Common/Flag.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/Timer.h"
@@ -103,7 +104,14 @@ float g_vr_ir_x = 0, g_vr_ir_y = 0, g_vr_ir_z = 0;
 
 ControllerStyle vr_left_controller = CS_HYDRA_LEFT, vr_right_controller = CS_HYDRA_RIGHT;
 
-std::vector<TimewarpLogEntry> timewarp_logentries;
+OpcodeReplayLog g_opcode_replay_log;
+
+// Number of replays requested by StartOpcodeReplayBenchmark, 0 when no benchmark is running.
+static std::atomic<int> s_benchmark_replays{0};
+static Common::Flag s_benchmark_done;
+// Only accessed on the GPU thread until s_benchmark_done is set.
+static bool s_benchmark_recording = false;
+static std::string s_benchmark_report;
 
 bool g_opcode_replay_enabled = false;
 bool g_new_frame_just_rendered = false;
@@ -2216,6 +2224,119 @@ bool VR_PairViveControllers()
 #endif
 }
 
+void OpcodeReplayLog::Record(const u8* data, size_t size, bool is_preprocess)
+{
+  const size_t data_capacity = m_data.capacity();
+  const size_t entries_capacity = m_entries.capacity();
+
+  m_entries.push_back(Entry{m_data.size(), size, is_preprocess});
+  m_data.insert(m_data.end(), data, data + size);
+
+  if (m_data.capacity() != data_capacity)
+    ++m_allocation_count;
+  if (m_entries.capacity() != entries_capacity)
+    ++m_allocation_count;
+}
+
+void OpcodeReplayLog::Replay()
+{
+  for (const Entry& entry : m_entries)
+  {
+    u8* start = m_data.data() + entry.offset;
+    DataReader src(start, start + entry.size);
+    if (entry.is_preprocess)
+      OpcodeDecoder::Run<true>(src, nullptr, false);
+    else
+      OpcodeDecoder::Run<false>(src, nullptr, false);
+  }
+}
+
+void OpcodeReplayLog::Reset()
+{
+  m_data_high_water = std::max(m_data_high_water, m_data.size());
+  m_entries_high_water = std::max(m_entries_high_water, m_entries.size());
+  m_data.clear();
+  m_entries.clear();
+  // Size the arena for the largest frame seen so far, so recording doesn't reallocate.
+  m_data.reserve(m_data_high_water);
+  m_entries.reserve(m_entries_high_water);
+}
+
+void OpcodeReplayLog::Clear()
+{
+  m_data = std::vector<u8>();
+  m_entries = std::vector<Entry>();
+  m_data_high_water = 0;
+  m_entries_high_water = 0;
+  m_allocation_count = 0;
+}
+
+void StartOpcodeReplayBenchmark(int replays)
+{
+  s_benchmark_done.Clear();
+  s_benchmark_replays.store(replays);
+}
+
+bool IsOpcodeReplayBenchmarkRunning()
+{
+  return s_benchmark_replays.load() > 0;
+}
+
+bool IsOpcodeReplayBenchmarkDone()
+{
+  return s_benchmark_done.IsSet();
+}
+
+std::string GetOpcodeReplayBenchmarkReport()
+{
+  if (!s_benchmark_done.IsSet())
+    return "";
+  return s_benchmark_report;
+}
+
+// Called on the GPU thread whenever a new frame has been rendered while a benchmark is running.
+static void OpcodeReplayBenchmarkFrame()
+{
+  if (!s_benchmark_recording)
+  {
+    g_opcode_replay_log.Clear();
+    skipped_opcode_replay_count = g_ActiveConfig.iExtraVideoLoopsDivider;
+    g_opcode_replay_log_frame = true;
+    s_benchmark_recording = true;
+    return;
+  }
+
+  s_benchmark_recording = false;
+  g_opcode_replay_log_frame = false;
+
+  const int replays = s_benchmark_replays.load();
+  const size_t lists = g_opcode_replay_log.GetEntryCount();
+  const size_t bytes = g_opcode_replay_log.GetDataSize();
+  const u32 allocations = g_opcode_replay_log.GetAllocationCount();
+
+  g_opcode_replay_frame = true;
+  const u64 start = Common::Timer::GetTimeUs();
+  for (int i = 0; i < replays; ++i)
+    g_opcode_replay_log.Replay();
+  const u64 elapsed_us = std::max<u64>(Common::Timer::GetTimeUs() - start, 1);
+  g_opcode_replay_frame = false;
+  g_opcode_replay_log.Reset();
+
+  const double seconds = elapsed_us / 1000000.0;
+  s_benchmark_report = StringFromFormat(
+      "Opcode replay benchmark: %d replays in %.3f ms\n"
+      "  Recorded frame:   %zu command lists, %zu bytes, %u arena allocations\n"
+      "  Replay rate:      %.1f frames/s (%.3f ms/frame)\n"
+      "  Decode cost:      %.1f ns/command list, %.1f MB/s\n",
+      replays, elapsed_us / 1000.0, lists, bytes, allocations, replays / seconds,
+      elapsed_us / 1000.0 / replays, lists ? elapsed_us * 1000.0 / (double(lists) * replays) : 0.0,
+      double(bytes) * replays / (1024.0 * 1024.0) / seconds);
+  NOTICE_LOG(VR, "%s", s_benchmark_report.c_str());
+
+  s_benchmark_replays.store(0);
+  s_benchmark_done.Set();
+}
+
 void OpcodeReplayBuffer()
 {
   // Opcode Replay Buffer Code.  This enables the capture of all the Video Opcodes that occur during
@@ -2326,35 +2447,25 @@ void OpcodeReplayBuffer()
         ++extra_video_loops_count;
         skipped_opcode_replay_count = 0;
 
-        for (TimewarpLogEntry& entry : timewarp_logentries)
-        {
-          // VertexManager::s_pCurBufferPointer = s_pCurBufferPointer_log.at(i);
-          // VertexManager::s_pEndBufferPointer = s_pEndBufferPointer_log.at(i);
-          // VertexManager::s_pBaseBufferPointer = s_pBaseBufferPointer_log.at(i);
-
-          // if (i == 0)
-          //{
-          // SCPFifoStruct &fifo = CommandProcessor::fifo;
-
-          // fifo.CPBase = CPBase_log.at(i);
-          // fifo.CPEnd = CPEnd_log.at(i);
-          // fifo.CPHiWatermark = CPHiWatermark_log.at(i);
-          // fifo.CPLoWatermark = CPLoWatermark_log.at(i);
-          // fifo.CPReadWriteDistance = CPReadWriteDistance_log.at(i);
-          // fifo.CPWritePointer = CPWritePointer_log.at(i);
-          // fifo.CPReadPointer = CPReadPointer_log.at(i);
-          // fifo.CPBreakpoint = CPBreakpoint_log.at(i);
-          //}
-
-          if (entry.is_preprocess_log)
-          {
-            OpcodeDecoder::Run<true>(entry.timewarp_log, nullptr, false);
-          }
-          else
-          {
-            OpcodeDecoder::Run<false>(entry.timewarp_log, nullptr, false);
-          }
-        }
+        // VertexManager::s_pCurBufferPointer = s_pCurBufferPointer_log.at(i);
+        // VertexManager::s_pEndBufferPointer = s_pEndBufferPointer_log.at(i);
+        // VertexManager::s_pBaseBufferPointer = s_pBaseBufferPointer_log.at(i);
+
+        // if (i == 0)
+        //{
+        // SCPFifoStruct &fifo = CommandProcessor::fifo;
+
+        // fifo.CPBase = CPBase_log.at(i);
+        // fifo.CPEnd = CPEnd_log.at(i);
+        // fifo.CPHiWatermark = CPHiWatermark_log.at(i);
+        // fifo.CPLoWatermark = CPLoWatermark_log.at(i);
+        // fifo.CPReadWriteDistance = CPReadWriteDistance_log.at(i);
+        // fifo.CPWritePointer = CPWritePointer_log.at(i);
+        // fifo.CPReadPointer = CPReadPointer_log.at(i);
+        // fifo.CPBreakpoint = CPBreakpoint_log.at(i);
+        //}
+
+        g_opcode_replay_log.Replay();
       }
       else
       {
@@ -2382,16 +2493,14 @@ void OpcodeReplayBuffer()
       // s_pEndBufferPointer_log.resize(0);
       // s_pBaseBufferPointer_log.clear();
       // s_pBaseBufferPointer_log.resize(0);
-      timewarp_logentries.clear();
-      timewarp_logentries.resize(0);
+      g_opcode_replay_log.Reset();
     }
   }
   else
   {
     if (g_opcode_replay_enabled)
     {
-      timewarp_logentries.clear();
-      timewarp_logentries.resize(0);
+      g_opcode_replay_log.Clear();
     }
     g_opcode_replay_enabled = false;
     g_opcode_replay_log_frame = false;
@@ -2400,6 +2509,12 @@ void OpcodeReplayBuffer()
 
 void OpcodeReplayBufferInline()
 {
+  if (IsOpcodeReplayBenchmarkRunning())
+  {
+    OpcodeReplayBenchmarkFrame();
+    return;
+  }
+
   // Opcode Replay Buffer Code.  This enables the capture of all the Video Opcodes that occur during
   // a frame,
   // and then plays them back with new headtracking information.  Allows ways to easily set
@@ -2525,29 +2640,15 @@ void OpcodeReplayBufferInline()
     skipped_opcode_replay_count = 0;
 
     for (int num_extra_frames = 0; num_extra_frames < extra_video_loops; ++num_extra_frames)
-    {
-      for (TimewarpLogEntry& entry : timewarp_logentries)
-      {
-        if (entry.is_preprocess_log)
-        {
-          OpcodeDecoder::Run<true>(entry.timewarp_log, nullptr, false);
-        }
-        else
-        {
-          OpcodeDecoder::Run<false>(entry.timewarp_log, nullptr, false);
-        }
-      }
-    }
-    timewarp_logentries.clear();
-    timewarp_logentries.resize(0);
+      g_opcode_replay_log.Replay();
+    g_opcode_replay_log.Reset();
     g_opcode_replay_frame = false;
   }
   else
   {
     if (g_opcode_replay_enabled)
     {
-      timewarp_logentries.clear();
-      timewarp_logentries.resize(0);
+      g_opcode_replay_log.Clear();
     }
     g_opcode_replay_enabled = false;
     g_opcode_replay_log_frame = false;
@@ -103,7 +103,10 @@ const int DEFAULT_VR_EXTRA_VIDEO_LOOPS_DIVIDER = 0;
 extern const char* scm_vr_sdk_str;
 
 #include <atomic>
+#include <cstddef>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "Common/MathUtil.h"
 #include "VideoCommon/DataReader.h"
@@ -234,12 +237,48 @@ extern bool g_vr_has_ir;
 extern float g_vr_ir_x, g_vr_ir_y, g_vr_ir_z;
 
 // Opcode Replay Buffer
-struct TimewarpLogEntry
+// Frame-scoped log of the command lists decoded while g_opcode_replay_log_frame is set. The FIFO
+// data is copied into an arena owned by the log, since the FIFO may already have been overwritten
+// by the time the frame is replayed.
+class OpcodeReplayLog
 {
-  DataReader timewarp_log;
-  bool is_preprocess_log;
+public:
+  void Record(const u8* data, size_t size, bool is_preprocess);
+  // Decodes every recorded command list again, in the order they were recorded.
+  void Replay();
+  // Forgets the recorded command lists, keeping the arena sized for the next frame.
+  void Reset();
+  // Releases the arena.
+  void Clear();
+
+  size_t GetEntryCount() const { return m_entries.size(); }
+  size_t GetDataSize() const { return m_data.size(); }
+  // Number of times recording had to grow the arena since the last Clear().
+  u32 GetAllocationCount() const { return m_allocation_count; }
+
+private:
+  struct Entry
+  {
+    size_t offset;
+    size_t size;
+    bool is_preprocess;
+  };
+
+  std::vector<u8> m_data;
+  std::vector<Entry> m_entries;
+  // Largest amount of data and number of entries recorded in a single frame so far.
+  size_t m_data_high_water = 0;
+  size_t m_entries_high_water = 0;
+  u32 m_allocation_count = 0;
 };
-extern std::vector<TimewarpLogEntry> timewarp_logentries;
+extern OpcodeReplayLog g_opcode_replay_log;
+
+// Opcode replay benchmark. Records the next frame into the opcode replay log, then replays it the
+// requested number of times on the GPU thread and measures how long that took.
+void StartOpcodeReplayBenchmark(int replays);
+bool IsOpcodeReplayBenchmarkRunning();
+bool IsOpcodeReplayBenchmarkDone();
+std::string GetOpcodeReplayBenchmarkReport();
 extern bool g_opcode_replay_enabled;
 extern bool g_new_frame_just_rendered;
 extern bool g_first_pass;
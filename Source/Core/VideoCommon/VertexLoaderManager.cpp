@@ -17,11 +17,13 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/HW/Memmap.h"
+#include "Core/HideObjectEngine.h"
 
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/PipelineTimings.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VR.h"
 #include "VideoCommon/VertexLoaderBase.h"
@@ -48,8 +50,12 @@ static VertexLoaderMap s_vertex_loader_map;
 
 u8* cached_arraybases[12];
 
+// Snapshot of the active hide object codes, only replaced between frames.
+static std::shared_ptr<const HideObjectEngine::Matcher> s_hide_object_matcher;
+
 void Init()
 {
+  RefreshHideObjectMatcher();
   MarkAllDirty();
   for (auto& map_entry : g_main_cp_state.vertex_loaders)
     map_entry = nullptr;
@@ -63,6 +69,12 @@ void Clear()
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
   s_vertex_loader_map.clear();
   s_native_vertex_map.clear();
+  s_hide_object_matcher.reset();
+}
+
+void RefreshHideObjectMatcher()
+{
+  s_hide_object_matcher = HideObjectEngine::GetActiveMatcher();
 }
 
 void UpdateVertexArrayPointers()
@@ -258,6 +270,8 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   if (!count)
     return 0;
 
+  PipelineTimings::ScopedStage timing(PipelineTimings::Stage::VertexLoading, !is_preprocess);
+
   SConfig& m_LocalCoreStartupParameter = SConfig::GetInstance();
 
   VertexLoaderBase* loader = RefreshLoader(vtx_attr_group, is_preprocess);
@@ -301,20 +315,17 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
     return size;
 
   // Hide Objects Code code
-  if (!m_LocalCoreStartupParameter.hide_objects_updating)
+  if (s_hide_object_matcher && !s_hide_object_matcher->IsEmpty())
   {
-    m_LocalCoreStartupParameter.hide_objects_done = false;
-    for (const SkipEntry& entry : m_LocalCoreStartupParameter.object_removal_codes)
+    int probes = 0;
+    const bool hidden = s_hide_object_matcher->Matches(src.GetPointer(), src.size(), &probes);
+    ADDSTAT(stats.thisFrame.numHideObjectProbes, probes);
+    if (hidden)
     {
-      // Set lock so codes can be enabled/disabled in game without crashes.
-      if (!memcmp(src.GetPointer(), entry.data(), entry.size()))
-      {
-        // Data didn't match, try next object_removal_code
-        return size;
-      }
+      INCSTAT(stats.thisFrame.numHiddenObjects);
+      return size;
     }
   }
-  m_LocalCoreStartupParameter.hide_objects_done = true;
 
   // If the native vertex format changed, force a flush.
   if (loader->m_native_vertex_format != s_current_vtx_fmt ||
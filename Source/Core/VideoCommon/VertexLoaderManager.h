@@ -22,6 +22,10 @@ using NativeVertexFormatMap =
 void Init();
 void Clear();
 
+// Picks up the hide object codes most recently applied by HideObjectEngine. Called on the GPU
+// thread between frames, so a draw never sees a partially updated set of codes.
+void RefreshHideObjectMatcher();
+
 void MarkAllDirty();
 
 // Creates or obtains a pointer to a VertexFormat representing decl.
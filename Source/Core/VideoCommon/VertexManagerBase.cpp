@@ -26,6 +26,7 @@
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/PipelineTimings.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/SamplerCommon.h"
@@ -276,6 +277,8 @@ void VertexManagerBase::Flush()
   if (m_is_flushed)
     return;
 
+  PipelineTimings::ScopedStage timing(PipelineTimings::Stage::Flush);
+
   // loading a state will invalidate BP, so check for it
   g_video_backend->CheckInvalidState();
 
@@ -0,0 +1,164 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AudioCommon/Resampler.h"
+#include "Common/CommonTypes.h"
+
+using namespace AudioCommon::Resampler;
+
+namespace
+{
+constexpr u32 COUNT = 1000;
+
+struct Input
+{
+  // Room for the filter history and lookahead on both sides of the samples.
+  std::vector<s16> left = std::vector<s16>(4 * COUNT);
+  std::vector<s16> right = std::vector<s16>(4 * COUNT);
+
+  const s16* Left() const { return &left[SINC_HISTORY]; }
+  const s16* Right() const { return &right[SINC_HISTORY]; }
+};
+
+Input RandomInput(u32 seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> dist(-32768, 32767);
+  Input input;
+  for (size_t i = 0; i < input.left.size(); ++i)
+  {
+    input.left[i] = static_cast<s16>(dist(rng));
+    input.right[i] = static_cast<s16>(dist(rng));
+  }
+  return input;
+}
+
+const u32 s_ratios[] = {0x1000, 0x10000, 0x0AAAB, 0x18000, 0x1FFFF};
+}  // namespace
+
+TEST(Resampler, LinearMatchesReference)
+{
+  const Input input = RandomInput(1);
+  std::vector<s32> left(COUNT), right(COUNT);
+
+  for (u32 ratio : s_ratios)
+  {
+    const u32 pos = ResampleLinear(input.left.data(), input.right.data(), left.data(),
+                                   right.data(), COUNT, 0x1234, ratio);
+    EXPECT_EQ(0x1234 + COUNT * ratio, pos);
+
+    // The per-sample code the mixer used before, without its integer overflow.
+    u32 ref_pos = 0x1234;
+    for (u32 i = 0; i < COUNT; ++i, ref_pos += ratio)
+    {
+      const u32 index = ref_pos >> 16;
+      const s64 frac = ref_pos & 0xFFFF;
+      const s64 l1 = input.left[index], l2 = input.left[index + 1];
+      const s64 r1 = input.right[index], r2 = input.right[index + 1];
+      ASSERT_EQ((l1 * 0x10000 + (l2 - l1) * frac) >> 16, left[i]);
+      ASSERT_EQ((r1 * 0x10000 + (r2 - r1) * frac) >> 16, right[i]);
+    }
+  }
+}
+
+TEST(Resampler, SincTablePhasesHaveUnityGain)
+{
+  auto table = std::make_unique<SincTable>();
+  for (float cutoff : {0.2f, 0.6f, 0.9f, 1.0f})
+  {
+    BuildSincTable(table.get(), cutoff);
+    for (const auto& phase : table->phases)
+    {
+      s32 sum = 0;
+      for (s16 coef : phase)
+        sum += coef;
+      EXPECT_EQ(1 << 14, sum);
+    }
+  }
+}
+
+TEST(Resampler, SincMatchesReference)
+{
+  const Input input = RandomInput(2);
+  auto table = std::make_unique<SincTable>();
+  BuildSincTable(table.get(), 0.9f);
+  std::vector<s32> left(COUNT), right(COUNT);
+
+  for (u32 ratio : s_ratios)
+  {
+    const u32 pos = ResampleSinc(*table, input.Left(), input.Right(), left.data(), right.data(),
+                                 COUNT, 0xABCD, ratio);
+    EXPECT_EQ(0xABCD + COUNT * ratio, pos);
+
+    u32 ref_pos = 0xABCD;
+    for (u32 i = 0; i < COUNT; ++i, ref_pos += ratio)
+    {
+      const auto& coefs = table->phases[(ref_pos & 0xFFFF) >> (16 - SINC_PHASE_BITS)];
+      // Left() and Right() skip exactly the history of the first position.
+      const size_t first = ref_pos >> 16;
+      s64 sum_l = 0, sum_r = 0;
+      for (u32 j = 0; j < SINC_TAPS; ++j)
+      {
+        sum_l += input.left[first + j] * coefs[j];
+        sum_r += input.right[first + j] * coefs[j];
+      }
+      ASSERT_EQ((sum_l + (1 << 13)) >> 14, left[i]);
+      ASSERT_EQ((sum_r + (1 << 13)) >> 14, right[i]);
+    }
+  }
+}
+
+TEST(Resampler, SincPassesIntegerPositionsThrough)
+{
+  // Without lowering the cutoff, the filter is zero at all other input frames.
+  const Input input = RandomInput(3);
+  auto table = std::make_unique<SincTable>();
+  BuildSincTable(table.get(), 1.0f);
+  std::vector<s32> left(COUNT), right(COUNT);
+
+  ResampleSinc(*table, input.Left(), input.Right(), left.data(), right.data(), COUNT, 0, 0x10000);
+  for (u32 i = 0; i < COUNT; ++i)
+  {
+    ASSERT_EQ(input.Left()[i], left[i]);
+    ASSERT_EQ(input.Right()[i], right[i]);
+  }
+}
+
+TEST(Resampler, SincRemovesFrequenciesAboveCutoff)
+{
+  // A tone at 90% of the input Nyquist frequency, downsampled by 2.
+  Input input;
+  for (size_t i = 0; i < input.left.size(); ++i)
+  {
+    input.left[i] = static_cast<s16>(16000 * std::sin(0.9 * 3.14159265358979 * i));
+    input.right[i] = static_cast<s16>(16000 * std::cos(0.9 * 3.14159265358979 * i));
+  }
+
+  auto table = std::make_unique<SincTable>();
+  BuildSincTable(table.get(), 0.45f);
+  std::vector<s32> left(COUNT), right(COUNT);
+  ResampleSinc(*table, input.Left(), input.Right(), left.data(), right.data(), COUNT, 0, 0x20000);
+
+  double linear_power = 0.0, sinc_power = 0.0;
+  std::vector<s32> linear_left(COUNT), linear_right(COUNT);
+  ResampleLinear(input.Left(), input.Right(), linear_left.data(), linear_right.data(), COUNT, 0,
+                 0x20000);
+  for (u32 i = 0; i < COUNT; ++i)
+  {
+    linear_power += double(linear_left[i]) * linear_left[i];
+    linear_power += double(linear_right[i]) * linear_right[i];
+    sinc_power += double(left[i]) * left[i] + double(right[i]) * right[i];
+  }
+
+  // Linear interpolation lets the tone alias through almost unchanged.
+  EXPECT_GT(linear_power, 0.5 * COUNT * 16000.0 * 16000.0);
+  EXPECT_LT(sinc_power, 0.01 * linear_power);
+}
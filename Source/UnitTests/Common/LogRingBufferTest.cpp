@@ -0,0 +1,100 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+#include "Common/Logging/LogRingBuffer.h"
+#include "Common/StringUtil.h"
+
+static LogRecordHeader MakeHeader(u64 sequence, const std::string& text)
+{
+  LogRecordHeader header{};
+  header.sequence = sequence;
+  header.file = __FILE__;
+  header.line = __LINE__;
+  header.text_length = static_cast<u16>(text.size());
+  return header;
+}
+
+TEST(LogRingBuffer, Simple)
+{
+  LogRingBuffer buffer(256);
+
+  EXPECT_TRUE(buffer.IsEmpty());
+  EXPECT_EQ(0u, buffer.PopAll([](const LogRecordHeader&, const char*) {}));
+
+  const std::string text = "Hello";
+  EXPECT_TRUE(buffer.Push(MakeHeader(7, text), text.data()));
+  EXPECT_FALSE(buffer.IsEmpty());
+
+  std::string popped;
+  u64 sequence = 0;
+  EXPECT_EQ(1u, buffer.PopAll([&](const LogRecordHeader& header, const char* msg) {
+    sequence = header.sequence;
+    popped.assign(msg, header.text_length);
+  }));
+  EXPECT_EQ(7u, sequence);
+  EXPECT_EQ(text, popped);
+  EXPECT_TRUE(buffer.IsEmpty());
+}
+
+TEST(LogRingBuffer, FullAndWrapAround)
+{
+  // Records of odd sizes make the wrap point move around on every lap.
+  LogRingBuffer buffer(200);
+  u64 next_push = 0;
+  u64 next_pop = 0;
+
+  for (int lap = 0; lap < 50; ++lap)
+  {
+    while (true)
+    {
+      const std::string text(next_push % 37, static_cast<char>('a' + next_push % 26));
+      if (!buffer.Push(MakeHeader(next_push, text), text.data()))
+        break;
+      ++next_push;
+    }
+    EXPECT_LE(buffer.GetUsedSize(), buffer.GetCapacity());
+
+    buffer.PopAll([&](const LogRecordHeader& header, const char* msg) {
+      EXPECT_EQ(next_pop, header.sequence);
+      EXPECT_EQ(std::string(next_pop % 37, static_cast<char>('a' + next_pop % 26)),
+                std::string(msg, header.text_length));
+      ++next_pop;
+    });
+    EXPECT_EQ(next_push, next_pop);
+    EXPECT_TRUE(buffer.IsEmpty());
+  }
+}
+
+TEST(LogRingBuffer, MultiThreaded)
+{
+  constexpr u64 NUM_RECORDS = 100000;
+  LogRingBuffer buffer(4096);
+
+  std::thread writer([&buffer] {
+    for (u64 i = 0; i < NUM_RECORDS; ++i)
+    {
+      const std::string text = StringFromFormat("message %llu", static_cast<unsigned long long>(i));
+      while (!buffer.Push(MakeHeader(i, text), text.data()))
+        std::this_thread::yield();
+    }
+  });
+
+  u64 next = 0;
+  while (next < NUM_RECORDS)
+  {
+    buffer.PopAll([&](const LogRecordHeader& header, const char* msg) {
+      EXPECT_EQ(next, header.sequence);
+      EXPECT_EQ(StringFromFormat("message %llu", static_cast<unsigned long long>(next)),
+                std::string(msg, header.text_length));
+      ++next;
+    });
+  }
+
+  writer.join();
+  EXPECT_TRUE(buffer.IsEmpty());
+}
@@ -0,0 +1,78 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/MPSCQueue.h"
+
+TEST(MPSCQueue, Simple)
+{
+  Common::MPSCQueue<u32, 16> q;
+
+  EXPECT_TRUE(q.Empty());
+
+  EXPECT_TRUE(q.Push(1));
+  EXPECT_FALSE(q.Empty());
+
+  u32 v;
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_EQ(1u, v);
+  EXPECT_TRUE(q.Empty());
+  EXPECT_FALSE(q.Pop(v));
+
+  // Test the FIFO order and the capacity, several times around the ring.
+  for (u32 lap = 0; lap < 3; ++lap)
+  {
+    for (u32 i = 0; i < 16; ++i)
+      EXPECT_TRUE(q.Push(i));
+    EXPECT_FALSE(q.Push(16));
+
+    for (u32 i = 0; i < 16; ++i)
+    {
+      u32 v2;
+      EXPECT_TRUE(q.Pop(v2));
+      EXPECT_EQ(i, v2);
+    }
+    EXPECT_TRUE(q.Empty());
+  }
+}
+
+TEST(MPSCQueue, MultiThreaded)
+{
+  constexpr u32 NUM_WRITERS = 4;
+  constexpr u32 VALUES_PER_WRITER = 100000;
+  Common::MPSCQueue<u32, 256> q;
+
+  std::vector<std::thread> writers;
+  for (u32 writer = 0; writer < NUM_WRITERS; ++writer)
+  {
+    writers.emplace_back([&q, writer] {
+      for (u32 i = 0; i < VALUES_PER_WRITER; ++i)
+      {
+        while (!q.Push(writer << 24 | i))
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  std::array<u32, NUM_WRITERS> next{};
+  for (u32 i = 0; i < NUM_WRITERS * VALUES_PER_WRITER; ++i)
+  {
+    u32 v;
+    while (!q.Pop(v))
+      ;
+    const u32 writer = v >> 24;
+    ASSERT_LT(writer, NUM_WRITERS);
+    // Values from one writer arrive in the order they were pushed.
+    EXPECT_EQ(next[writer], v & 0xFFFFFF);
+    ++next[writer];
+  }
+  EXPECT_TRUE(q.Empty());
+
+  for (std::thread& writer : writers)
+    writer.join();
+}
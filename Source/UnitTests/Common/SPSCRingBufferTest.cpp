@@ -0,0 +1,112 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/SPSCRingBuffer.h"
+
+TEST(SPSCRingBuffer, Simple)
+{
+  Common::SPSCRingBuffer<u32, 16> ring;
+  std::array<u32, 16> data;
+  for (u32 i = 0; i < 16; ++i)
+    data[i] = i;
+
+  EXPECT_EQ(0u, ring.Size());
+  EXPECT_EQ(3u, ring.Push(data.data(), 3));
+  EXPECT_EQ(3u, ring.Size());
+
+  std::array<u32, 16> out{};
+  EXPECT_EQ(2u, ring.Peek(out.data(), 2, 1));
+  EXPECT_EQ(1u, out[0]);
+  EXPECT_EQ(2u, out[1]);
+  EXPECT_EQ(0u, ring.Peek(out.data(), 2, 3));
+  EXPECT_EQ(3u, ring.Size());
+
+  EXPECT_EQ(3u, ring.Pop(out.data(), 16));
+  EXPECT_EQ(0u, out[0]);
+  EXPECT_EQ(2u, out[2]);
+  EXPECT_EQ(0u, ring.Size());
+  EXPECT_EQ(0u, ring.Discard(1));
+
+  // Test the FIFO order and the capacity, several times around the ring and with the read
+  // position not at the start.
+  for (u32 lap = 0; lap < 3; ++lap)
+  {
+    EXPECT_EQ(10u, ring.Push(data.data(), 10));
+    EXPECT_EQ(6u, ring.Push(data.data() + 10, 10));
+    EXPECT_EQ(0u, ring.Push(data.data(), 1));
+    EXPECT_EQ(16u, ring.Size());
+
+    out.fill(0);
+    EXPECT_EQ(16u, ring.Peek(out.data(), 20));
+    EXPECT_EQ(data, out);
+
+    EXPECT_EQ(5u, ring.Discard(5));
+    EXPECT_EQ(5u, ring.Push(data.data(), 5));
+    EXPECT_EQ(16u, ring.Pop(out.data(), 16));
+    for (u32 i = 0; i < 16; ++i)
+      EXPECT_EQ((i + 5) % 16, out[i]);
+  }
+}
+
+TEST(SPSCRingBuffer, PushWithCopy)
+{
+  Common::SPSCRingBuffer<u32, 8> ring;
+  const auto negate = [](const u32* begin, const u32* end, u32* out) {
+    std::transform(begin, end, out, [](u32 value) { return 0 - value; });
+  };
+
+  const std::array<u32, 6> data = {{1, 2, 3, 4, 5, 6}};
+  EXPECT_EQ(6u, ring.Push(data.data(), 6, negate));
+  EXPECT_EQ(6u, ring.Discard(6));
+  // Wraps around the end of the buffer.
+  EXPECT_EQ(6u, ring.Push(data.data(), 6, negate));
+
+  std::array<u32, 6> out;
+  EXPECT_EQ(6u, ring.Pop(out.data(), 6));
+  for (u32 i = 0; i < 6; ++i)
+    EXPECT_EQ(0 - data[i], out[i]);
+}
+
+TEST(SPSCRingBuffer, MultiThreaded)
+{
+  constexpr u32 VALUES = 100000;
+  Common::SPSCRingBuffer<u32, 256> ring;
+
+  std::thread writer([&ring] {
+    std::array<u32, 100> batch;
+    u32 next = 0;
+    while (next < VALUES)
+    {
+      // Vary the batch size, so that the batches don't line up with the end of the buffer.
+      const u32 count = std::min<u32>(next % 97 + 1, VALUES - next);
+      for (u32 i = 0; i < count; ++i)
+        batch[i] = next + i;
+      const size_t pushed = ring.Push(batch.data(), count);
+      if (pushed == 0)
+        std::this_thread::yield();
+      next += static_cast<u32>(pushed);
+    }
+  });
+
+  std::array<u32, 64> out;
+  u32 expected = 0;
+  while (expected < VALUES)
+  {
+    const size_t count = ring.Pop(out.data(), expected % 63 + 1);
+    if (count == 0)
+      std::this_thread::yield();
+    for (size_t i = 0; i < count; ++i)
+      ASSERT_EQ(expected++, out[i]);
+  }
+
+  writer.join();
+  EXPECT_EQ(0u, ring.Size());
+}
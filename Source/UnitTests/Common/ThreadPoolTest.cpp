@@ -0,0 +1,44 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <future>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Common/ThreadPool.h"
+
+TEST(ThreadPool, Results)
+{
+  Common::ThreadPool pool(4, "ThreadPoolTest");
+  EXPECT_EQ(4u, pool.GetThreadCount());
+
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 1000; ++i)
+    results.push_back(pool.Schedule([i] { return i * i; }));
+
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(i * i, results[i].get());
+}
+
+TEST(ThreadPool, Reset)
+{
+  std::atomic<int> counter{0};
+  Common::ThreadPool pool;
+  EXPECT_EQ(0u, pool.GetThreadCount());
+
+  for (size_t threads = 1; threads <= 3; ++threads)
+  {
+    pool.Reset(threads, "ThreadPoolTest");
+    EXPECT_EQ(threads, pool.GetThreadCount());
+
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 100; ++i)
+      results.push_back(pool.Schedule([&counter] { ++counter; }));
+    for (std::future<void>& result : results)
+      result.get();
+  }
+
+  EXPECT_EQ(300, counter);
+}
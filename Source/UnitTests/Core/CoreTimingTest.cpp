@@ -4,10 +4,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "Common/ChunkFile.h"
 #include "Common/Config/Config.h"
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
@@ -288,6 +292,165 @@ TEST(CoreTiming, ScheduleIntoPast)
   AdvanceAndCheck(0, MAX_SLICE_LENGTH, 1000);
 }
 
+TEST(CoreTiming, RemoveEvent)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+  CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+  CoreTiming::EventType* cb_c = CoreTiming::RegisterEvent("callbackC", CallbackTemplate<2>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  CoreTiming::ScheduleEvent(100, cb_a, CB_IDS[0]);
+  CoreTiming::ScheduleEvent(200, cb_b, CB_IDS[1]);
+  CoreTiming::ScheduleEvent(300, cb_c, CB_IDS[2]);
+  EXPECT_EQ(100, PowerPC::ppcState.downcount);
+
+  // Events scheduled after the removal must not be affected by it.
+  CoreTiming::RemoveEvent(cb_a);
+  CoreTiming::ScheduleEvent(250, cb_a, CB_IDS[0]);
+
+  s_callbacks_ran_flags = 0;
+  PowerPC::ppcState.downcount = 0;
+  CoreTiming::Advance();
+  EXPECT_TRUE(s_callbacks_ran_flags.none());
+  EXPECT_EQ(100, PowerPC::ppcState.downcount);
+
+  AdvanceAndCheck(1, 50);
+  AdvanceAndCheck(0, 50);
+  AdvanceAndCheck(2, MAX_SLICE_LENGTH);
+}
+
+TEST(CoreTiming, FarFutureEvents)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+  CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  // Far enough in the future to be outside of the event queue's timing wheel at first.
+  constexpr s64 FAR_EVENT = 2000000;
+  CoreTiming::ScheduleEvent(FAR_EVENT, cb_b, CB_IDS[1]);
+  CoreTiming::ScheduleEvent(1000, cb_a, CB_IDS[0]);
+  EXPECT_EQ(1000, PowerPC::ppcState.downcount);
+
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH);
+
+  for (s64 remaining = FAR_EVENT - 1000 - MAX_SLICE_LENGTH; remaining > 0;
+       remaining -= MAX_SLICE_LENGTH)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+    EXPECT_EQ(std::min<s64>(remaining, MAX_SLICE_LENGTH), PowerPC::ppcState.downcount);
+  }
+
+  AdvanceAndCheck(1, MAX_SLICE_LENGTH);
+}
+
+TEST(CoreTiming, LoadStateWithEarlierTime)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+  CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+  CoreTiming::EventType* cb_c = CoreTiming::RegisterEvent("callbackC", CallbackTemplate<2>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  std::vector<u8> state;
+  PointerWrap save(&state);
+  CoreTiming::DoState(save);
+  save.FinishWrite();
+
+  // Move the event queue far past the time of the state, then go back to it.
+  for (int i = 0; i < 1000; ++i)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  u8* ptr = state.data();
+  PointerWrap load(&ptr, PointerWrap::MODE_READ);
+  CoreTiming::DoState(load);
+  ASSERT_EQ(0u, CoreTiming::GetTicks());
+
+  // The events must still run in order, and not before they are due.
+  CoreTiming::ScheduleEvent(3000, cb_c, CB_IDS[2]);
+  CoreTiming::ScheduleEvent(500, cb_a, CB_IDS[0]);
+  CoreTiming::ScheduleEvent(1500, cb_b, CB_IDS[1]);
+  EXPECT_EQ(500, PowerPC::ppcState.downcount);
+
+  AdvanceAndCheck(0, 1000);
+  AdvanceAndCheck(1, 1500);
+  AdvanceAndCheck(2, MAX_SLICE_LENGTH);
+}
+
+namespace ConcurrentSchedulingTest
+{
+static constexpr u32 NUM_PRODUCERS = 4;
+// More than fit into the cross-thread queue at once, so its overflow path is exercised too.
+static constexpr u32 EVENTS_PER_PRODUCER = 5000;
+static std::array<u32, NUM_PRODUCERS> s_received;
+
+static void ProducerCallback(u64 userdata, s64 lateness)
+{
+  const u32 producer = static_cast<u32>(userdata >> 32);
+  const u32 sequence = static_cast<u32>(userdata);
+  ASSERT_LT(producer, NUM_PRODUCERS);
+  // The events of one producer must arrive in the order they were scheduled.
+  EXPECT_EQ(s_received[producer], sequence);
+  ++s_received[producer];
+}
+}
+
+TEST(CoreTiming, ConcurrentScheduling)
+{
+  using namespace ConcurrentSchedulingTest;
+
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_producer =
+      CoreTiming::RegisterEvent("callbackProducer", ProducerCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  s_received.fill(0);
+  std::vector<std::thread> producers;
+  for (u32 i = 0; i < NUM_PRODUCERS; ++i)
+  {
+    producers.emplace_back([cb_producer, i] {
+      for (u32 j = 0; j < EVENTS_PER_PRODUCER; ++j)
+      {
+        CoreTiming::ScheduleEvent(0, cb_producer, (static_cast<u64>(i) << 32) | j,
+                                  CoreTiming::FromThread::NON_CPU);
+      }
+    });
+  }
+
+  u32 total = 0;
+  while (total < NUM_PRODUCERS * EVENTS_PER_PRODUCER)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+
+    total = 0;
+    for (u32 received : s_received)
+      total += received;
+  }
+
+  for (std::thread& producer : producers)
+    producer.join();
+
+  for (u32 received : s_received)
+    EXPECT_EQ(EVENTS_PER_PRODUCER, received);
+}
+
 TEST(CoreTiming, Overclocking)
 {
   ScopeInit guard;
@@ -0,0 +1,144 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
+
+namespace AXMix = DSP::HLE::AXMix;
+
+// The per-sample code AXVoice.h used before the kernels were vectorized.
+static s16 ReferenceScale(s16 sample, u16 volume)
+{
+  s64 scaled = sample;
+  scaled *= volume;
+  scaled >>= 15;
+  return static_cast<s16>(std::min(std::max(static_cast<s32>(scaled), -32767), 32767));
+}
+
+// Every kernel this CPU can run, so that each one gets compared with the reference and not only
+// the one that gets picked by default.
+static std::vector<AXMix::Kernel> GetSupportedKernels()
+{
+  std::vector<AXMix::Kernel> kernels = {AXMix::Kernel::Scalar};
+#if defined(_M_X86) || defined(_M_X86_64)
+  if (cpu_info.bSSE4_1)
+    kernels.push_back(AXMix::Kernel::SSE41);
+  if (cpu_info.bAVX2)
+    kernels.push_back(AXMix::Kernel::AVX2);
+#elif defined(_M_ARM_64)
+  kernels.push_back(AXMix::Kernel::NEON);
+#endif
+  return kernels;
+}
+
+struct TestCase
+{
+  u16 volume;
+  u16 volume_delta;
+};
+
+static const TestCase s_test_cases[] = {
+    {0x8000, 0},       {0x7FFF, 0},     {0xFFFF, 0},     {0, 0x0100},
+    {0xFF00, 0x0123},  // Wraps around during the buffer.
+    {0x0040, 0xFFF0},  // Negative delta that wraps below 0.
+    {0x1234, 0x5678},
+};
+
+TEST(AXMix, ApplyVolumeMatchesReference)
+{
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> dist(-32768, 32767);
+
+  for (const TestCase& test : s_test_cases)
+  {
+    for (u32 count = 0; count <= 96; ++count)
+    {
+      std::vector<s16> samples(count);
+      for (s16& sample : samples)
+        sample = static_cast<s16>(dist(rng));
+      if (count)
+        samples[0] = -32768;
+
+      std::vector<s16> expected = samples;
+      u16 expected_volume = test.volume;
+      for (s16& sample : expected)
+      {
+        sample = ReferenceScale(sample, expected_volume);
+        expected_volume += test.volume_delta;
+      }
+
+      for (AXMix::Kernel kernel : GetSupportedKernels())
+      {
+        SCOPED_TRACE(static_cast<int>(kernel));
+        std::vector<s16> result = samples;
+        u16 volume = test.volume;
+        AXMix::ApplyVolume(kernel, result.data(), count, &volume, test.volume_delta);
+        EXPECT_EQ(expected, result);
+        EXPECT_EQ(expected_volume, volume);
+      }
+
+      u16 volume = test.volume;
+      AXMix::ApplyVolume(samples.data(), count, &volume, test.volume_delta);
+      EXPECT_EQ(expected, samples);
+      EXPECT_EQ(expected_volume, volume);
+    }
+  }
+}
+
+TEST(AXMix, MixAddMatchesReference)
+{
+  std::mt19937 rng(5678);
+  std::uniform_int_distribution<int> dist(-32768, 32767);
+
+  for (const TestCase& test : s_test_cases)
+  {
+    for (u32 count = 0; count <= 96; ++count)
+    {
+      std::vector<s16> input(count);
+      std::vector<int> out(count);
+      for (u32 i = 0; i < count; ++i)
+      {
+        input[i] = static_cast<s16>(dist(rng));
+        out[i] = dist(rng) * 100;
+      }
+
+      std::vector<int> expected = out;
+      u16 expected_volume = test.volume;
+      s16 expected_dpop = 0x55;
+      for (u32 i = 0; i < count; ++i)
+      {
+        expected_dpop = ReferenceScale(input[i], expected_volume);
+        expected[i] += expected_dpop;
+        expected_volume += test.volume_delta;
+      }
+
+      for (AXMix::Kernel kernel : GetSupportedKernels())
+      {
+        SCOPED_TRACE(static_cast<int>(kernel));
+        std::vector<int> result = out;
+        u16 volume = test.volume;
+        s16 dpop = 0x55;
+        AXMix::MixAdd(kernel, result.data(), input.data(), count, &volume, test.volume_delta,
+                      &dpop);
+        EXPECT_EQ(expected, result);
+        EXPECT_EQ(expected_volume, volume);
+        EXPECT_EQ(expected_dpop, dpop);
+      }
+
+      u16 volume = test.volume;
+      s16 dpop = 0x55;
+      AXMix::MixAdd(out.data(), input.data(), count, &volume, test.volume_delta, &dpop);
+      EXPECT_EQ(expected, out);
+      EXPECT_EQ(expected_volume, volume);
+      EXPECT_EQ(expected_dpop, dpop);
+    }
+  }
+}
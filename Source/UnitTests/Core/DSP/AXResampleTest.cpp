@@ -0,0 +1,177 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/AXResample.h"
+#include "Core/HW/DSPHLE/UCodes/AXStructs.h"
+
+using namespace DSP::HLE;
+
+// Computes the expected output directly from the definition instead of following the ucode's
+// loop: output sample k is taken at the absolute position (curr_pos + (k + 1) * ratio) in the
+// input, which is preceded by the four last samples. The filters are evaluated in floating point
+// and rounded down, which is exact for these magnitudes.
+static u32 ReferenceResample(const std::vector<s16>& input, size_t* read_pos, s16* output,
+                             u32 count, s16* last_samples, u32 curr_pos, u32 ratio, int srctype,
+                             const s16* coeffs)
+{
+  const u64 start = curr_pos & 0xFFFF;
+  const u64 end = start + static_cast<u64>(ratio) * count;
+  const auto sample_at = [&](u64 index) -> double {
+    return index < 4 ? last_samples[index] : input[*read_pos + index - 4];
+  };
+
+  for (u32 k = 0; k < count; ++k)
+  {
+    const u64 pos = start + static_cast<u64>(ratio) * (k + 1);
+    const u64 index = pos >> 16;
+    const u32 frac = pos & 0xFFFF;
+
+    double value;
+    if (coeffs && srctype == SRCTYPE_POLYPHASE)
+    {
+      const s16* c = &coeffs[(frac >> 9) * 4];
+      value = 0;
+      for (u32 j = 0; j < 4; ++j)
+        value += sample_at(index + j) * c[j];
+      value /= 0x8000;
+    }
+    else
+    {
+      value = sample_at(index) + (sample_at(index + 1) - sample_at(index)) * frac / 0x10000;
+    }
+
+    value = std::floor(value);
+    if (value > 32767)
+      value = 32767;
+    if (value < -32768)
+      value = -32768;
+    output[k] = static_cast<s16>(value);
+  }
+
+  const u64 consumed = end >> 16;
+  s16 new_last[4];
+  for (u32 j = 0; j < 4; ++j)
+    new_last[j] = static_cast<s16>(sample_at(consumed + j));
+  std::copy(new_last, new_last + 4, last_samples);
+  *read_pos += consumed;
+  return end & 0xFFFF;
+}
+
+class AXResampleTest : public testing::TestWithParam<int>
+{
+protected:
+  void SetUp() override
+  {
+    std::mt19937 rng(4321);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    m_input.resize(0x200000);
+    for (s16& sample : m_input)
+      sample = static_cast<s16>(dist(rng));
+    // Full scale runs make the polyphase filter overshoot.
+    std::fill(m_input.begin() + 100, m_input.begin() + 200, 32767);
+    std::fill(m_input.begin() + 200, m_input.begin() + 300, -32768);
+
+    // Taps which sum to more than 1.0, like the DROM coefficients do for some phases.
+    m_coeffs.resize(0x200);
+    for (size_t i = 0; i < m_coeffs.size(); ++i)
+      m_coeffs[i] = static_cast<s16>(dist(rng) / 2 + (i % 4 == 1 ? 0x4000 : 0));
+  }
+
+  void Check(u32 ratio, u32 count)
+  {
+    const int srctype = GetParam();
+    const s16* coeffs = m_coeffs.data();
+
+    s16 expected_last[4] = {1, -2, 3, -4};
+    s16 last[4] = {1, -2, 3, -4};
+    u32 expected_pos = 0x1234;
+    u32 pos = 0x1234;
+    size_t expected_read = 0;
+    size_t read = 0;
+
+    const auto read_input = [this, &read](s16* buffer, u32 input_count) {
+      ASSERT_LE(read + input_count, m_input.size());
+      std::copy(m_input.begin() + read, m_input.begin() + read + input_count, buffer);
+      read += input_count;
+    };
+
+    // Several calls, to check that the state is carried over correctly.
+    for (int call = 0; call < 3; ++call)
+    {
+      std::vector<s16> expected(count);
+      std::vector<s16> output(count);
+      expected_pos = ReferenceResample(m_input, &expected_read, expected.data(), count,
+                                       expected_last, expected_pos, ratio, srctype, coeffs);
+      pos = AXResample::ResampleAudio(read_input, output.data(), count, last, pos, ratio, srctype,
+                                      coeffs);
+
+      ASSERT_EQ(expected, output) << "ratio " << ratio << " count " << count;
+      ASSERT_EQ(expected_pos, pos);
+      ASSERT_EQ(expected_read, read);
+      ASSERT_TRUE(std::equal(last, last + 4, expected_last));
+    }
+  }
+
+  std::vector<s16> m_input;
+  std::vector<s16> m_coeffs;
+};
+
+TEST_P(AXResampleTest, MatchesReference)
+{
+  for (u32 ratio : {0x0u, 0x1u, 0x8000u, 0xFFFFu, 0x10000u, 0x10001u, 0x15555u, 0x55555u,
+                    0x2ABCDu, 0x1000000u, 0x1010101u})
+  {
+    for (u32 count : {1u, 5u, 32u, 96u})
+      Check(ratio, count);
+  }
+}
+
+TEST_P(AXResampleTest, MatchesReferenceAcrossBlocks)
+{
+  // Ratios for which the input of a single call does not fit in a block.
+  for (u32 ratio : {0x30000u, 0x40000u, 0x7FFFFu, 0x123456u})
+    Check(ratio, 96);
+}
+
+INSTANTIATE_TEST_CASE_P(SrcTypes, AXResampleTest,
+                        testing::Values(static_cast<int>(SRCTYPE_POLYPHASE),
+                                        static_cast<int>(SRCTYPE_LINEAR)));
+
+TEST(AXResample, PolyphaseSaturates)
+{
+  // Phase 0 sums to 1.5, phase 1 to 0.5. The other phases are never used here.
+  std::vector<s16> coeffs(0x200);
+  const s16 phase0[4] = {0x4000, 0x4000, 0x4000, 0};
+  const s16 phase1[4] = {0, 0x2000, 0x2000, 0};
+  std::copy(phase0, phase0 + 4, coeffs.begin());
+  std::copy(phase1, phase1 + 4, coeffs.begin() + 4);
+
+  for (s16 value : {s16(32767), s16(-32768), s16(1000)})
+  {
+    const auto read_input = [value](s16* buffer, u32 input_count) {
+      std::fill(buffer, buffer + input_count, value);
+    };
+    s16 last[4] = {value, value, value, value};
+    s16 output[2];
+
+    // An integer ratio stays on phase 0, 0x200 more moves to phase 1.
+    u32 pos = AXResample::ResampleAudio(read_input, output, 1, last, 0, 0x10000,
+                                        SRCTYPE_POLYPHASE, coeffs.data());
+    pos = AXResample::ResampleAudio(read_input, output + 1, 1, last, pos, 0x10200,
+                                    SRCTYPE_POLYPHASE, coeffs.data());
+    EXPECT_EQ(0x200u, pos);
+
+    const s16 expected_full = value == 1000 ? 1500 : value;
+    EXPECT_EQ(expected_full, output[0]);
+    EXPECT_EQ(value / 2, output[1]);
+  }
+}
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -185,3 +187,112 @@ TEST(DSPAccelerator, CurrentAddressSkips)
   accelerator.TestRead();
   EXPECT_EQ(accelerator.GetCurrentAddress(), 0x00000013u);
 }
+
+// Accelerator reading from random memory, which loops back to the start address on end
+// exceptions like the AX ucode does for looping voices.
+class MemoryAccelerator : public DSP::Accelerator
+{
+public:
+  explicit MemoryAccelerator(u32 seed) : m_memory(0x400)
+  {
+    std::mt19937 rng(seed);
+    for (u8& byte : m_memory)
+      byte = static_cast<u8>(rng());
+  }
+
+  int GetEndExceptionCount() const { return m_end_exceptions; }
+  bool ReadsStopped() const { return m_reads_stopped; }
+  void SetLooping(bool looping) { m_looping = looping; }
+protected:
+  void OnEndException() override
+  {
+    ++m_end_exceptions;
+    if (m_looping)
+      SetYn2(GetYn2());
+  }
+  u8 ReadMemory(u32 address) override { return m_memory[address % m_memory.size()]; }
+  void WriteMemory(u32 address, u8 value) override {}
+  std::vector<u8> m_memory;
+  int m_end_exceptions = 0;
+  bool m_looping = true;
+};
+
+static void CheckReadSamples(u16 format, u32 start, u32 end, u32 current, bool looping)
+{
+  std::array<s16, 16> coefs;
+  std::mt19937 rng(start * 31 + end);
+  for (s16& coef : coefs)
+    coef = static_cast<s16>(rng());
+
+  MemoryAccelerator expected(1234), actual(1234);
+  for (MemoryAccelerator* accelerator : {&expected, &actual})
+  {
+    accelerator->SetSampleFormat(format);
+    accelerator->SetStartAddress(start);
+    accelerator->SetEndAddress(end);
+    accelerator->SetCurrentAddress(current);
+    accelerator->SetPredScale(0x35);
+    accelerator->SetYn1(100);
+    accelerator->SetYn2(-200);
+    accelerator->SetLooping(looping);
+  }
+
+  // Odd request sizes, so that reads start at all kinds of addresses.
+  for (u32 count : {1u, 7u, 16u, 33u, 100u, 5u, 300u, 2u})
+  {
+    std::vector<s16> expected_samples;
+    for (u32 i = 0; i < count; ++i)
+      expected_samples.push_back(static_cast<s16>(expected.Read(coefs.data())));
+
+    std::vector<s16> samples(count);
+    u32 read = 0;
+    int reads = 0;
+    while (read < count)
+    {
+      read += actual.ReadSamples(samples.data() + read, count - read, coefs.data());
+      ASSERT_LE(++reads, 100);
+    }
+
+    EXPECT_EQ(expected_samples, samples);
+    EXPECT_EQ(expected.GetCurrentAddress(), actual.GetCurrentAddress());
+    EXPECT_EQ(expected.GetYn1(), actual.GetYn1());
+    EXPECT_EQ(expected.GetYn2(), actual.GetYn2());
+    EXPECT_EQ(expected.GetPredScale(), actual.GetPredScale());
+    EXPECT_EQ(expected.GetEndExceptionCount(), actual.GetEndExceptionCount());
+    EXPECT_EQ(expected.ReadsStopped(), actual.ReadsStopped());
+  }
+}
+
+TEST(DSPAccelerator, ReadSamplesMatchesRead)
+{
+  for (u16 format : {0x00, 0x0A, 0x19})
+  {
+    for (bool looping : {true, false})
+    {
+      // End addresses in the middle of frames and at both special cases.
+      for (u32 end : {0x40u, 0x41u, 0x4Fu, 0x50u, 0x51u, 0x123u, 0x200u})
+      {
+        SCOPED_TRACE(testing::Message() << "format " << format << " end " << end);
+        CheckReadSamples(format, 0x22, end, 0x22, looping);
+        CheckReadSamples(format, 0x10, end, 0x13, looping);
+        CheckReadSamples(format, 0x2, end, end - 3, looping);
+        // Past the end address, reads go on until the address wraps around.
+        CheckReadSamples(format, 0x2, end, end + 2, looping);
+      }
+    }
+  }
+}
+
+TEST(DSPAccelerator, ReadSamplesStopsAtEndException)
+{
+  std::array<s16, 16> coefs{};
+  MemoryAccelerator accelerator(5678);
+  accelerator.SetStartAddress(0x02);
+  accelerator.SetEndAddress(0x0C);
+  accelerator.SetCurrentAddress(0x02);
+
+  std::array<s16, 32> samples;
+  EXPECT_EQ(11u, accelerator.ReadSamples(samples.data(), 32, coefs.data()));
+  EXPECT_EQ(1, accelerator.GetEndExceptionCount());
+  EXPECT_EQ(0x02u, accelerator.GetCurrentAddress());
+}
@@ -0,0 +1,140 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/MovieInput.h"
+
+using Movie::InputLog;
+
+static std::vector<u8> MakeInput(size_t size, u8 seed)
+{
+  std::vector<u8> input(size);
+  for (size_t i = 0; i < size; ++i)
+    input[i] = static_cast<u8>(i * 13 + seed);
+  return input;
+}
+
+static std::vector<u8> ReadAll(const InputLog& log)
+{
+  std::vector<u8> data(static_cast<size_t>(log.GetSize()));
+  EXPECT_TRUE(log.Read(0, data.data(), data.size()));
+  return data;
+}
+
+class MovieInputTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = File::CreateTempDir();
+    ASSERT_FALSE(m_dir.empty());
+  }
+  void TearDown() override { File::DeleteDirRecursively(m_dir); }
+
+  void WriteFile(const std::string& path, const std::vector<u8>& header,
+                 const std::vector<u8>& input)
+  {
+    File::IOFile file(path, "wb");
+    ASSERT_TRUE(file.WriteBytes(header.data(), header.size()));
+    ASSERT_TRUE(file.WriteBytes(input.data(), input.size()));
+  }
+
+  std::string m_dir;
+};
+
+TEST_F(MovieInputTest, RecordsAcrossChunksAndSpills)
+{
+  InputLog log(m_dir + "/journal");
+  std::vector<u8> expected;
+
+  // Odd record sizes make the records straddle chunk boundaries.
+  for (u8 i = 0; expected.size() < 3 * InputLog::SPILL_SIZE; ++i)
+  {
+    const std::vector<u8> record = MakeInput(37, i);
+    log.Write(expected.size(), record.data(), record.size());
+    expected.insert(expected.end(), record.begin(), record.end());
+  }
+
+  EXPECT_TRUE(File::Exists(m_dir + "/journal"));
+  EXPECT_EQ(expected.size(), log.GetSize());
+  EXPECT_EQ(expected, ReadAll(log));
+
+  u8 byte;
+  EXPECT_FALSE(log.Read(expected.size(), &byte, 1));
+  EXPECT_TRUE(log.Read(expected.size() - 1, &byte, 1));
+  EXPECT_EQ(expected.back(), byte);
+
+  log.Clear();
+  EXPECT_TRUE(log.IsEmpty());
+  EXPECT_FALSE(File::Exists(m_dir + "/journal"));
+}
+
+TEST_F(MovieInputTest, WriteTruncates)
+{
+  InputLog log(m_dir + "/journal");
+  std::vector<u8> expected = MakeInput(InputLog::SPILL_SIZE + 1000, 1);
+  log.Write(0, expected.data(), expected.size());
+
+  // Rewrite part of what was spilled to the journal, like recording after loading a state.
+  const std::vector<u8> branch = MakeInput(500, 2);
+  log.Write(1234, branch.data(), branch.size());
+  expected.resize(1234);
+  expected.insert(expected.end(), branch.begin(), branch.end());
+  EXPECT_EQ(expected, ReadAll(log));
+
+  log.Write(1000, nullptr, 0);
+  expected.resize(1000);
+  EXPECT_EQ(expected, ReadAll(log));
+}
+
+TEST_F(MovieInputTest, MapsAndDetachesFiles)
+{
+  const std::string path = m_dir + "/movie.dtm";
+  const std::vector<u8> header(256, 0xdd);
+  const std::vector<u8> input = MakeInput(100000, 3);
+  WriteFile(path, header, input);
+
+  InputLog log(m_dir + "/journal");
+  ASSERT_TRUE(log.MapFile(path, header.size()));
+  EXPECT_EQ(input, ReadAll(log));
+  EXPECT_EQ(input.size(), log.FindMismatch(input.data(), input.size()));
+
+  std::vector<u8> changed = input;
+  changed[54321] ^= 1;
+  EXPECT_EQ(54321u, log.FindMismatch(changed.data(), changed.size()));
+
+  // Saving over the mapped file must not affect the input.
+  log.Detach(path);
+  WriteFile(path, header, MakeInput(10, 4));
+  EXPECT_EQ(input, ReadAll(log));
+
+  File::IOFile out(m_dir + "/copy.dtm", "wb");
+  ASSERT_TRUE(log.WriteTo(out));
+  out.Close();
+  ASSERT_TRUE(log.CopyFile(m_dir + "/copy.dtm", 0));
+  EXPECT_EQ(input, ReadAll(log));
+}
+
+TEST_F(MovieInputTest, ReplaceStart)
+{
+  InputLog log(m_dir + "/journal");
+  std::vector<u8> expected = MakeInput(InputLog::SPILL_SIZE + 5000, 5);
+  log.Write(0, expected.data(), expected.size());
+
+  // Once inside the spilled input, and once past it.
+  for (size_t size : {size_t(777), size_t(InputLog::SPILL_SIZE + 100)})
+  {
+    const std::vector<u8> start = MakeInput(size, static_cast<u8>(size));
+    log.ReplaceStart(start.data(), start.size());
+    std::copy(start.begin(), start.end(), expected.begin());
+    EXPECT_EQ(expected, ReadAll(log));
+  }
+}
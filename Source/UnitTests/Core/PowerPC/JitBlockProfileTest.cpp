@@ -0,0 +1,119 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Core/PowerPC/JitCommon/JitBlockProfile.h"
+
+static JitBlockProfile::Entry MakeEntry(u32 address, u32 msr_bits, u64 hash)
+{
+  return {address, msr_bits, address & 0x3fffffff, 8, hash};
+}
+
+static void ExpectSameEntries(const std::vector<JitBlockProfile::Entry>& expected,
+                              const std::vector<JitBlockProfile::Entry>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    EXPECT_EQ(expected[i].effective_address, actual[i].effective_address);
+    EXPECT_EQ(expected[i].msr_bits, actual[i].msr_bits);
+    EXPECT_EQ(expected[i].physical_address, actual[i].physical_address);
+    EXPECT_EQ(expected[i].num_instructions, actual[i].num_instructions);
+    EXPECT_EQ(expected[i].hash, actual[i].hash);
+  }
+}
+
+class JitBlockProfileTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_dir = File::CreateTempDir();
+    ASSERT_FALSE(m_dir.empty());
+  }
+  void TearDown() override { File::DeleteDirRecursively(m_dir); }
+
+  std::string m_dir;
+};
+
+TEST_F(JitBlockProfileTest, AddIgnoresDuplicates)
+{
+  JitBlockProfile profile;
+  profile.Add(MakeEntry(0x80003100, 0x30, 1));
+  profile.Add(MakeEntry(0x80003200, 0x30, 2));
+  // Same block again, and the same address with other MSR bits or other code.
+  profile.Add(MakeEntry(0x80003100, 0x30, 1));
+  profile.Add(MakeEntry(0x80003100, 0x00, 1));
+  profile.Add(MakeEntry(0x80003100, 0x30, 3));
+
+  ExpectSameEntries({MakeEntry(0x80003100, 0x30, 1), MakeEntry(0x80003200, 0x30, 2),
+                     MakeEntry(0x80003100, 0x00, 1), MakeEntry(0x80003100, 0x30, 3)},
+                    profile.GetEntries());
+
+  profile.Clear();
+  EXPECT_TRUE(profile.GetEntries().empty());
+  profile.Add(MakeEntry(0x80003100, 0x30, 1));
+  EXPECT_EQ(1u, profile.GetEntries().size());
+}
+
+TEST_F(JitBlockProfileTest, SaveLoadRoundTrip)
+{
+  const std::string filename = m_dir + "/profiles/GALE01.jbp";
+
+  JitBlockProfile saved;
+  for (u32 i = 0; i < 100; ++i)
+    saved.Add(MakeEntry(0x80004000 + i * 0x20, i % 2 ? 0x30 : 0x10, i * 0x9e3779b97f4a7c15ULL));
+  ASSERT_TRUE(saved.Save(filename));
+
+  JitBlockProfile loaded;
+  loaded.Add(MakeEntry(0x81000000, 0, 0));
+  ASSERT_TRUE(loaded.Load(filename));
+  ExpectSameEntries(saved.GetEntries(), loaded.GetEntries());
+
+  // Merging like the block cache does on shutdown keeps the order and drops the duplicates.
+  JitBlockProfile session;
+  session.Add(MakeEntry(0x80100000, 0x30, 7));
+  session.Add(saved.GetEntries()[3]);
+  for (const JitBlockProfile::Entry& entry : loaded.GetEntries())
+    session.Add(entry);
+  ASSERT_EQ(saved.GetEntries().size() + 1, session.GetEntries().size());
+  EXPECT_EQ(0x80100000u, session.GetEntries()[0].effective_address);
+  EXPECT_EQ(saved.GetEntries()[3].effective_address, session.GetEntries()[1].effective_address);
+  EXPECT_EQ(saved.GetEntries()[0].effective_address, session.GetEntries()[2].effective_address);
+}
+
+TEST_F(JitBlockProfileTest, LoadRejectsInvalidFiles)
+{
+  JitBlockProfile profile;
+  profile.Add(MakeEntry(0x80003100, 0x30, 1));
+  EXPECT_FALSE(profile.Load(m_dir + "/missing.jbp"));
+  EXPECT_TRUE(profile.GetEntries().empty());
+
+  const std::string filename = m_dir + "/garbage.jbp";
+  {
+    File::IOFile file(filename, "wb");
+    const std::vector<u8> garbage(64, 0xab);
+    ASSERT_TRUE(file.WriteBytes(garbage.data(), garbage.size()));
+  }
+  EXPECT_FALSE(profile.Load(filename));
+  EXPECT_TRUE(profile.GetEntries().empty());
+
+  // A truncated file is rejected as well.
+  JitBlockProfile saved;
+  saved.Add(MakeEntry(0x80003100, 0x30, 1));
+  saved.Add(MakeEntry(0x80003200, 0x30, 2));
+  ASSERT_TRUE(saved.Save(filename));
+  {
+    File::IOFile file(filename, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 1));
+  }
+  EXPECT_FALSE(profile.Load(filename));
+}
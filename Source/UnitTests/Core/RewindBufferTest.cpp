@@ -0,0 +1,183 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/RewindBuffer.h"
+
+using State::RewindBuffer;
+
+static std::vector<u8> MakeState(size_t size, u8 seed)
+{
+  std::vector<u8> state(size);
+  for (size_t i = 0; i < size; ++i)
+    state[i] = static_cast<u8>(i * 7 + seed);
+  return state;
+}
+
+TEST(RewindBuffer, PopRestoresSnapshotsInReverseOrder)
+{
+  RewindBuffer buffer;
+  std::vector<std::vector<u8>> states;
+  states.push_back(MakeState(10 * RewindBuffer::PAGE_SIZE + 123, 0));
+  for (u8 i = 1; i < 5; ++i)
+  {
+    std::vector<u8> state = states.back();
+    state[i * RewindBuffer::PAGE_SIZE + 5] ^= 0xff;
+    state.back() = i;
+    states.push_back(state);
+  }
+
+  for (const auto& state : states)
+    buffer.Push(std::vector<u8>(state));
+  EXPECT_EQ(states.size(), buffer.GetSnapshotCount());
+
+  // Each older snapshot only differs from the next one in two pages.
+  EXPECT_LT(buffer.GetMemoryUsage(), states[0].size() + 5 * 2 * RewindBuffer::PAGE_SIZE);
+
+  std::vector<u8> popped;
+  for (auto it = states.rbegin(); it != states.rend(); ++it)
+  {
+    ASSERT_TRUE(buffer.Pop(&popped));
+    EXPECT_EQ(*it, popped);
+  }
+  EXPECT_FALSE(buffer.Pop(&popped));
+  EXPECT_TRUE(buffer.IsEmpty());
+  EXPECT_EQ(0u, buffer.GetMemoryUsage());
+}
+
+TEST(RewindBuffer, SizeChanges)
+{
+  RewindBuffer buffer;
+  const std::vector<u8> small = MakeState(3 * RewindBuffer::PAGE_SIZE + 1, 1);
+  const std::vector<u8> large = MakeState(5 * RewindBuffer::PAGE_SIZE + 17, 1);
+
+  buffer.Push(std::vector<u8>(large));
+  buffer.Push(std::vector<u8>(small));
+  buffer.Push(std::vector<u8>(large));
+
+  std::vector<u8> popped;
+  ASSERT_TRUE(buffer.Pop(&popped));
+  EXPECT_EQ(large, popped);
+  ASSERT_TRUE(buffer.Pop(&popped));
+  EXPECT_EQ(small, popped);
+  ASSERT_TRUE(buffer.Pop(&popped));
+  EXPECT_EQ(large, popped);
+}
+
+TEST(RewindBuffer, DropsOldestSnapshots)
+{
+  const size_t size = 4 * RewindBuffer::PAGE_SIZE;
+  RewindBuffer buffer(2 * size + RewindBuffer::PAGE_SIZE);
+
+  for (u8 i = 0; i < 10; ++i)
+    buffer.Push(MakeState(size, i));
+
+  // Every page differs between snapshots, so only one delta fits next to the latest state.
+  EXPECT_EQ(2u, buffer.GetSnapshotCount());
+  EXPECT_LE(buffer.GetMemoryUsage(), 2 * size + RewindBuffer::PAGE_SIZE);
+
+  std::vector<u8> popped;
+  ASSERT_TRUE(buffer.Pop(&popped));
+  EXPECT_EQ(MakeState(size, 9), popped);
+  ASSERT_TRUE(buffer.Pop(&popped));
+  EXPECT_EQ(MakeState(size, 8), popped);
+  EXPECT_FALSE(buffer.Pop(&popped));
+
+  buffer.SetMaxSize(1);
+  buffer.Push(MakeState(size, 0));
+  buffer.Push(MakeState(size, 1));
+  EXPECT_EQ(1u, buffer.GetSnapshotCount());
+}
+
+TEST(RewindBuffer, SectionsDontShiftLaterPages)
+{
+  RewindBuffer buffer;
+  const std::vector<u8> memory = MakeState(16 * RewindBuffer::PAGE_SIZE, 3);
+
+  // The first section grows between the snapshots, which moves the second one in the stream.
+  std::vector<u8> old_state = MakeState(100, 0);
+  const std::vector<size_t> old_sections = {old_state.size()};
+  old_state.insert(old_state.end(), memory.begin(), memory.end());
+
+  std::vector<u8> new_state = MakeState(150, 1);
+  const std::vector<size_t> new_sections = {new_state.size()};
+  new_state.insert(new_state.end(), memory.begin(), memory.end());
+  new_state[new_sections[0] + 5 * RewindBuffer::PAGE_SIZE] ^= 0xff;
+
+  buffer.Push(std::vector<u8>(old_state), old_sections);
+  buffer.Push(std::vector<u8>(new_state), new_sections);
+
+  // Only the first section and the one changed page of the second section are stored.
+  EXPECT_LT(buffer.GetMemoryUsage(), new_state.size() + 2 * RewindBuffer::PAGE_SIZE);
+
+  std::vector<u8> popped;
+  std::vector<size_t> popped_sections;
+  ASSERT_TRUE(buffer.Pop(&popped, &popped_sections));
+  EXPECT_EQ(new_state, popped);
+  EXPECT_EQ(new_sections, popped_sections);
+  ASSERT_TRUE(buffer.Pop(&popped, &popped_sections));
+  EXPECT_EQ(old_state, popped);
+  EXPECT_EQ(old_sections, popped_sections);
+}
+
+TEST(RewindBuffer, PushHandsBackThePreviousBuffer)
+{
+  RewindBuffer buffer;
+  std::vector<u8> state = MakeState(2 * RewindBuffer::PAGE_SIZE, 0);
+  const u8* first_data = state.data();
+  buffer.Push(std::move(state));
+  EXPECT_TRUE(state.empty());
+
+  state = MakeState(2 * RewindBuffer::PAGE_SIZE, 1);
+  buffer.Push(std::move(state));
+  EXPECT_EQ(first_data, state.data());
+}
+
+TEST(RewindBuffer, MemoryRegions)
+{
+  RewindBuffer buffer;
+  std::vector<u8> mem1 = MakeState(8 * RewindBuffer::PAGE_SIZE, 4);
+  std::vector<u8> mem2 = MakeState(16 * RewindBuffer::PAGE_SIZE + 100, 5);
+  const std::vector<RewindBuffer::MemoryRegion> regions = {{mem1.data(), mem1.size()},
+                                                           {mem2.data(), mem2.size()}};
+  const std::vector<u8> state = MakeState(100, 0);
+
+  std::vector<std::vector<u8>> mem1_history;
+  std::vector<std::vector<u8>> mem2_history;
+  for (u8 i = 0; i < 4; ++i)
+  {
+    mem1[i * RewindBuffer::PAGE_SIZE] ^= 0xff;
+    mem2.back() = i;
+    mem1_history.push_back(mem1);
+    mem2_history.push_back(mem2);
+    buffer.Push(std::vector<u8>(state), {}, regions);
+  }
+
+  // The regions are stored once, plus the two pages that changed for each older snapshot.
+  EXPECT_LT(buffer.GetMemoryUsage(),
+            state.size() + mem1.size() + mem2.size() + 3 * 2 * RewindBuffer::PAGE_SIZE + 256);
+
+  std::fill(mem1.begin(), mem1.end(), 0);
+  std::fill(mem2.begin(), mem2.end(), 0);
+  std::vector<u8> popped;
+  for (size_t i = mem1_history.size(); i-- > 0;)
+  {
+    ASSERT_TRUE(buffer.Pop(&popped, nullptr, regions));
+    EXPECT_EQ(state, popped);
+    EXPECT_EQ(mem1_history[i], mem1);
+    EXPECT_EQ(mem2_history[i], mem2);
+  }
+  EXPECT_FALSE(buffer.Pop(&popped, nullptr, regions));
+
+  // Regions of another size start a new history.
+  buffer.Push(std::vector<u8>(state), {}, regions);
+  buffer.Push(std::vector<u8>(state), {}, {{mem1.data(), mem1.size()}});
+  EXPECT_EQ(1u, buffer.GetSnapshotCount());
+}